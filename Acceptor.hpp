@@ -0,0 +1,371 @@
+/**
+ * Statistics acceptor generation for DEVSMap
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Builds an acceptor from the experimental frame of the experiment:
+ *
+ *  "experimental_frame": {
+ *      "statistics": {
+ *          "count": ["count", "mean", "variance", "min", "max",
+ *                    {"histogram": {"min": 0, "max": 100, "bins": 20}},
+ *                    {"quantiles": [0.5, 0.9, 0.99]}]
+ *      }
+ *  },
+ *  "pocc": [{"port_from": "count", "port_to": "count"}]
+ *
+ * Every pocc entry couples an arithmetic output port of the model under
+ * test to an input port of the acceptor, which keeps the statistics listed
+ * for that port. Mistakes in either section are collected by the
+ * constructor as diagnostics(), in the format of the Validator; write()
+ * expects none. Next to the generated headers it writes
+ *  - include/<top>_acceptor.hpp: a passive atomic folding each message into
+ *                                devsmap::statistics_t, see
+ *                                devsmap/statistics.hpp, with report()
+ *                                writing the summary as JSON
+ *  - include/<top>_frame.hpp:    a coupled model holding the model under
+ *                                test and the acceptor, coupled by pocc
+ *  - <top>_frame_main.cpp:       simulates the frame for the time_span of
+ *                                the experiment (or the time given on its
+ *                                command line) and prints the report
+ */
+
+#ifndef ACCEPTOR_HPP
+#define ACCEPTOR_HPP
+
+#include <charconv>
+#include <map>
+#include "DEVSMap_Parser.hpp"
+
+/////////////////////////////////////ACCEPTOR/////////////////////////////////////
+
+template<typename AMP, typename CMP>
+class Acceptor {
+    private:
+    struct observed_t {
+        std::string datatype;
+        json statistics;
+    };
+
+    const Parser<AMP, CMP>& parser;
+    std::string top;
+    std::string acceptor_name;
+    std::string frame_name;
+    std::map<std::string, observed_t> ports;        //!< acceptor input port -> what it receives and keeps
+    std::vector<std::pair<std::string, std::string>> couplings;
+    std::vector<validation_error_t> errors;
+
+    static std::string upper(std::string name) {
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        return name;
+    }
+
+    static std::string literal(double value) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        std::string text(buffer, result.ptr);
+        return text.find_first_of(".e") == std::string::npos ? text + ".0" : text;
+    }
+
+    static const std::map<std::string, std::string>& fields() {
+        static const std::map<std::string, std::string> names = {
+            {"count", "devsmap::COUNT"}, {"mean", "devsmap::MEAN"}, {"variance", "devsmap::VARIANCE"},
+            {"min", "devsmap::MIN"}, {"max", "devsmap::MAX"}
+        };
+        return names;
+    }
+
+    /**
+     * Reports what make_configuration could not turn into code in the
+     * statistics listed for port, found at path in the experiment
+     */
+    void check_statistics(const std::string& port, const json& statistics, const std::string& path) {
+        auto& file = parser.experiment_file();
+        if(!statistics.is_array()) {
+            errors.emplace_back(file, path, "STATISTICS OF ACCEPTOR PORT " + port + " MUST BE A LIST");
+            return;
+        }
+
+        for(size_t i = 0; i < statistics.size(); i++) {
+            auto& statistic = statistics[i];
+            std::string where = path + "/" + std::to_string(i);
+            if(statistic.is_string()) {
+                if(!fields().count(statistic.get<std::string>())) {
+                    errors.emplace_back(file, where, "UNKNOWN STATISTIC " + statistic.get<std::string>() + " FOR PORT " + port);
+                }
+            } else if(statistic.is_object() && statistic.contains("histogram")) {
+                auto& histogram = statistic.at("histogram");
+                if(!histogram.is_object() || !histogram.value("min", json()).is_number() || !histogram.value("max", json()).is_number()
+                    || !histogram.value("bins", json()).is_number_unsigned()) {
+                    errors.emplace_back(file, where + "/histogram", "HISTOGRAM NEEDS NUMBERS min, max AND bins FOR PORT " + port);
+                } else if(!(histogram.at("min").get<double>() < histogram.at("max").get<double>()) || histogram.at("bins").get<size_t>() == 0) {
+                    errors.emplace_back(file, where + "/histogram", "EMPTY HISTOGRAM FOR PORT " + port);
+                }
+            } else if(statistic.is_object() && statistic.contains("quantiles")) {
+                auto& quantiles = statistic.at("quantiles");
+                if(!quantiles.is_array()) {
+                    errors.emplace_back(file, where + "/quantiles", "QUANTILES MUST BE A LIST FOR PORT " + port);
+                    continue;
+                }
+                for(size_t j = 0; j < quantiles.size(); j++) {
+                    if(!quantiles[j].is_number() || quantiles[j].get<double>() < 0 || quantiles[j].get<double>() > 1) {
+                        errors.emplace_back(file, where + "/quantiles/" + std::to_string(j), "QUANTILE OUT OF [0, 1] FOR PORT " + port);
+                    }
+                }
+            } else {
+                errors.emplace_back(file, where, "UNKNOWN STATISTIC " + statistic.dump() + " FOR PORT " + port);
+            }
+        }
+    }
+
+    /**
+     * Statements configuring the statistics_t of one port, checked by check_statistics
+     */
+    static std::string make_configuration(const std::string& port, const json& statistics) {
+        std::ostringstream oss;
+        std::string report;
+
+        for(auto& statistic : statistics) {
+            if(statistic.is_string()) {
+                report += (report.empty() ? "" : " | ") + fields().at(statistic.get<std::string>());
+            } else if(statistic.contains("histogram")) {
+                auto& histogram = statistic.at("histogram");
+                oss << "\t\tstate." << port << ".histogram(" << literal(histogram.at("min").get<double>()) << ", " << literal(histogram.at("max").get<double>()) << ", " << histogram.at("bins").get<size_t>() << ");\n";
+            } else {
+                for(auto& quantile : statistic.at("quantiles")) {
+                    oss << "\t\tstate." << port << ".quantile(" << literal(quantile.get<double>()) << ");\n";
+                }
+            }
+        }
+
+        return "\t\tstate." + port + ".report(" + (report.empty() ? "0" : report) + ");\n" + oss.str();
+    }
+
+    public:
+    Acceptor(const Parser<AMP, CMP>& _parser): parser(_parser), top(_parser.top()) {
+        acceptor_name = top + "_acceptor";
+        frame_name = top + "_frame";
+        auto& file = parser.experiment_file();
+
+        auto model = parser.coupled(top);
+        if(!model) {
+            errors.emplace_back(file, "/model_under_test", "AN ACCEPTOR NEEDS A COUPLED MODEL UNDER TEST");
+            return;
+        }
+        auto& statistics = parser.frame().at("statistics");
+        if(!statistics.is_object()) {
+            errors.emplace_back(file, "/experimental_frame/statistics", "STATISTICS MUST BE AN OBJECT KEYED BY ACCEPTOR PORT");
+            return;
+        }
+        if(!parser.pocc().is_array()) {
+            errors.emplace_back(file, "/pocc", "POCC MUST BE A LIST OF COUPLINGS");
+            return;
+        }
+
+        for(size_t i = 0; i < parser.pocc().size(); i++) {
+            auto& coupling = parser.pocc()[i];
+            std::string path = "/pocc/" + std::to_string(i);
+            if(!coupling.is_object() || !coupling.value("port_from", json()).is_string() || !coupling.value("port_to", json()).is_string()) {
+                errors.emplace_back(file, path, "POCC COUPLING NEEDS port_from AND port_to");
+                continue;
+            }
+            std::string from = coupling.at("port_from").template get<std::string>();
+            std::string to = coupling.at("port_to").template get<std::string>();
+
+            auto port = std::find_if(model->get_output().begin(), model->get_output().end(), [&](auto& p) { return p.variable == from; });
+            if(port == model->get_output().end()) {
+                errors.emplace_back(file, path + "/port_from", "NO OUTPUT PORT " + from + " IN " + top);
+                continue;
+            }
+            if(!AMP::is_arithmetic(port->datatype)) {
+                errors.emplace_back(file, path + "/port_from", "OUTPUT PORT " + from + " OF TYPE " + port->datatype + " IS NOT ARITHMETIC, NO STATISTICS");
+                continue;
+            }
+            if(!statistics.contains(to)) {
+                errors.emplace_back(file, path + "/port_to", "NO STATISTICS FOR ACCEPTOR PORT " + to);
+                continue;
+            }
+
+            auto [it, inserted] = ports.emplace(to, observed_t{port->datatype, statistics.at(to)});
+            if(inserted) {
+                check_statistics(to, statistics.at(to), "/experimental_frame/statistics/" + to);
+            } else if(it->second.datatype != port->datatype) {
+                errors.emplace_back(file, path, "TYPE MISMATCH " + port->datatype + " --> " + it->second.datatype + " AT ACCEPTOR PORT " + to);
+                continue;
+            }
+            couplings.emplace_back(from, to);
+        }
+
+        if(ports.empty() && errors.empty()) {
+            errors.emplace_back(file, "/pocc", "NO POCC COUPLINGS TO OBSERVE");
+        }
+    }
+
+    /**
+     * Everything wrong with the statistics and pocc sections, empty when the acceptor can be written
+     */
+    const std::vector<validation_error_t>& diagnostics() const {
+        return errors;
+    }
+
+    /**
+     * Whether the experiment asks for an acceptor at all
+     */
+    static bool requested(const Parser<AMP, CMP>& parser) {
+        return parser.frame().contains("statistics");
+    }
+
+    std::string make_acceptor() const {
+        std::ostringstream oss;
+        std::string state_name = acceptor_name + "State";
+
+        oss << "#ifndef __DEVSMAP__PARSER__" << upper(acceptor_name) << "__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__" << upper(acceptor_name) << "__HPP__\n\n";
+        oss << "#include <iostream>\n#include <limits>\n#include \"cadmium/modeling/devs/atomic.hpp\"\n#include \"devsmap/statistics.hpp\"\n\n";
+        oss << "using namespace cadmium;\n\n";
+
+        oss << "struct " << state_name << " {\n";
+        for(auto& [port, _] : ports) {
+            oss << "\tdevsmap::statistics_t " << port << ";\n";
+        }
+        oss << "};\n";
+        oss << "inline std::ostream& operator<<(std::ostream& out, const " << state_name << "& s) {\n";
+        oss << "\tout << \"{\"";
+        for(auto it = ports.begin(); it != ports.end(); ++it) {
+            oss << (it == ports.begin() ? "" : " << \", \"") << " << \"" << it->first << ":\" << s." << it->first;
+        }
+        oss << " << \"}\";\n";
+        oss << "\treturn out;\n";
+        oss << "}\n\n";
+
+        oss << "class " << acceptor_name << ": public Atomic<" << state_name << ">{\n\n";
+        oss << "\tpublic:\n\n";
+        for(auto& [port, observed] : ports) {
+            oss << "\tPort<" << observed.datatype << "> " << port << ";\n";
+        }
+        oss << "\n";
+
+        oss << "\t" << acceptor_name << "(const std::string id): Atomic<" << state_name << ">(id, " << state_name << "()) {\n";
+        for(auto& [port, observed] : ports) {
+            oss << "\t\t" << port << " = addInPort<" << observed.datatype << ">(\"" << port << "\");\n";
+            oss << make_configuration(port, observed.statistics);
+        }
+        oss << "\t}\n\n";
+
+        oss << "\tvoid internalTransition(" << state_name << "& state) const override {}\n\n";
+
+        oss << "\tvoid externalTransition(" << state_name << "& state, double e) const override {\n";
+        for(auto& [port, _] : ports) {
+            oss << "\t\tfor(auto& x : " << port << "->getBag()) {\n";
+            oss << "\t\t\tstate." << port << ".push(static_cast<double>(x));\n";
+            oss << "\t\t}\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\tvoid output(const " << state_name << "& state) const override {}\n\n";
+
+        oss << "\t[[nodiscard]] double timeAdvance(const " << state_name << "& state) const override {\n";
+        oss << "\t\treturn std::numeric_limits<double>::infinity();\n";
+        oss << "\t}\n\n";
+
+        oss << "\t//! Summary of every observed port as one JSON object\n";
+        oss << "\tvoid report(std::ostream& out) const {\n";
+        oss << "\t\tout << \"{\";\n";
+        for(auto it = ports.begin(); it != ports.end(); ++it) {
+            oss << "\t\tout << \"" << (it == ports.begin() ? "" : ", ") << "\\\"" << it->first << "\\\": \";\n";
+            oss << "\t\tstate." << it->first << ".write(out);\n";
+        }
+        oss << "\t\tout << \"}\" << std::endl;\n";
+        oss << "\t}\n";
+        oss << "};\n\n";
+
+        oss << "#endif //__DEVSMAP__PARSER__" << upper(acceptor_name) << "__HPP__\n";
+
+        return oss.str();
+    }
+
+    /**
+     * Simulates the frame and prints the report of the acceptor on stdout
+     */
+    std::string make_runner() const {
+        std::ostringstream oss;
+
+        oss << "#include <iostream>\n#include <limits>\n#include <memory>\n#include <string>\n";
+        oss << "#include \"cadmium/simulation/root_coordinator.hpp\"\n";
+        oss << "#include \"" << frame_name << ".hpp\"\n\n";
+
+        oss << "int main(int argc, char** argv) {\n";
+        oss << "\tdouble end = argc > 1 ? std::stod(argv[1]) : ";
+        if(parser.time_span() == std::numeric_limits<double>::infinity()) {
+            oss << "std::numeric_limits<double>::infinity()";
+        } else {
+            oss << literal(parser.time_span());
+        }
+        oss << ";\n\n";
+
+        oss << "\tauto frame = std::make_shared<" << frame_name << ">(\"" << frame_name << "\");\n";
+        oss << "\tauto root = cadmium::RootCoordinator(frame);\n";
+        oss << "\troot.start();\n";
+        oss << "\troot.simulate(end);\n";
+        oss << "\troot.stop();\n";
+        oss << "\tframe->acceptor->report(std::cout);\n";
+        oss << "\treturn 0;\n";
+        oss << "}\n";
+
+        return oss.str();
+    }
+
+    std::string make_frame() const {
+        std::ostringstream oss;
+
+        oss << "#ifndef __DEVSMAP__PARSER__" << upper(frame_name) << "__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__" << upper(frame_name) << "__HPP__\n\n";
+        oss << "#include <memory>\n#include \"cadmium/modeling/devs/coupled.hpp\"\n";
+        oss << "#include \"" << top << ".hpp\"\n#include \"" << acceptor_name << ".hpp\"\n\n";
+        oss << "using namespace cadmium;\n\n";
+
+        oss << "struct " << frame_name << ": public Coupled {\n\n";
+        oss << "\tstd::shared_ptr<" << top << "> model;\n";
+        oss << "\tstd::shared_ptr<" << acceptor_name << "> acceptor;\n\n";
+        oss << "\t" << frame_name << "(const std::string& id) : Coupled(id) {\n";
+        oss << "\t\tmodel = addComponent<" << top << ">(\"" << top << "\");\n";
+        oss << "\t\tacceptor = addComponent<" << acceptor_name << ">(\"acceptor\");\n\n";
+        for(auto& [from, to] : couplings) {
+            oss << "\t\taddCoupling(model->" << from << ", acceptor->" << to << ");\n";
+        }
+        oss << "\t}\n";
+        oss << "};\n\n";
+
+        oss << "#endif //__DEVSMAP__PARSER__" << upper(frame_name) << "__HPP__\n";
+
+        return oss.str();
+    }
+
+    void write(const std::string& output_directory) const {
+        auto write_file = [](const std::string& filename, const std::string& content) {
+            std::ofstream file(filename.c_str());
+            file << content;
+            file.close();
+        };
+
+        write_file(output_directory + "/include/" + acceptor_name + ".hpp", make_acceptor());
+        write_file(output_directory + "/include/" + frame_name + ".hpp", make_frame());
+        write_file(output_directory + "/" + frame_name + "_main.cpp", make_runner());
+    }
+};
+
+#endif //ACCEPTOR_HPP
@@ -25,6 +25,7 @@
 #ifndef ATOMIC_PARSER_HPP
 #define ATOMIC_PARSER_HPP
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -32,8 +33,11 @@
 #include <unordered_map>
 #include <regex>
 #include <unordered_set>
+#include <functional>
+#include <limits>
 #include <nlohmann/json.hpp>
 #include "datatypes.hpp"
+#include "Profiler.hpp"
 
 using json = nlohmann::json;
 
@@ -42,7 +46,8 @@ const std::string fixed_keys[] = {"include_sets", "parameters", "graph"};
 const std::unordered_set<std::string> operators = {
     "==", "!=", "<=", ">=", "<", ">", "&&", "||",
     "(", ")", "+", "-", "*", "/", "%",
-    ".bag", ".bagSize"
+    ".bag", ".bagSize",
+    ".bagSum", ".bagMin", ".bagMax", ".bagAny", ".bagCount"
 };
 
 /////////////////////////////////////PARSER/////////////////////////////////////
@@ -66,9 +71,11 @@ class AtomicParser {
      * Takes the tokens, and classifies them further
      */
     std::vector<Token> tokenize_classify(const std::string& condition) {
+        profile_scope_t profile("tokenize_classify");
 
         std::vector<Token> tokens;
-        std::regex token_regex(R"((==|!=|<=|>=|&&|\|\||[()<>\+\-\*/%])|([A-Za-z_]\w*(?:\.bag\([^\)]+\)|\.bagSize\(\))?)|(\d+\.\d+|\d+)|(\".*?\"|\'.*?\'))");
+        // bagAny(cond) and bagCount(cond) may hold one level of parentheses
+        std::regex token_regex(R"((==|!=|<=|>=|&&|\|\||[()<>\+\-\*/%])|([A-Za-z_]\w*(?:\.bag\([^\)]+\)|\.bagSize\(\)|\.bag(?:Sum|Min|Max)\(\)|\.bag(?:Any|Count)\((?:[^()]|\([^()]*\))*\))?)|(\d+\.\d+|\d+)|(\".*?\"|\'.*?\'))");
 
         std::smatch match;
         std::string s = condition;
@@ -105,7 +112,7 @@ class AtomicParser {
 
                 std::string base_var = token.value;
 
-                // Check if token contains .bag() or .bagSize()
+                // Check if token contains .bag(), .bagSize() or an aggregate
                 size_t pos = token.value.find('.');
                 if (pos != std::string::npos) {
                     base_var = token.value.substr(0, pos);
@@ -128,6 +135,31 @@ class AtomicParser {
         return tokens;
     }
 
+    /**
+     * True if any expression of the model uses bagSum(), bagMin(), bagMax(),
+     * bagAny() or bagCount(), see devsmap/bag.hpp
+     */
+    bool uses_bag_aggregates() const {
+        static const std::regex aggregate_regex(R"(\.bag(Sum|Min|Max|Any|Count)\()");
+        return std::regex_search(model.dump(), aggregate_regex);
+    }
+
+    /**
+     * True if a ta leaf expression stands for an infinite time advance
+     */
+    static bool is_infinity(const std::string& expression) {
+        static const std::regex infinity_regex(R"(\s*\+?(inf|infinity|INF|INFINITY|Infinity)\s*)");
+        return std::regex_match(expression, infinity_regex);
+    }
+
+    /**
+     * True if a ta leaf expression is a non-negative numeric literal
+     */
+    static bool is_literal(const std::string& expression) {
+        static const std::regex literal_regex(R"(\s*\+?(\d+\.\d*|\d*\.\d+|\d+)\s*)");
+        return std::regex_match(expression, literal_regex);
+    }
+
     private:
     json DEVSMap;
 
@@ -251,10 +283,14 @@ class AtomicParser {
     }
 
     void parse(std::string fileName) {
-        std::ifstream atomicFile(fileName);
-        DEVSMap = json::parse(atomicFile);
-        atomicFile.close();
+        {
+            profile_scope_t profile("json_parse");
+            std::ifstream atomicFile(fileName);
+            DEVSMap = json::parse(atomicFile);
+            atomicFile.close();
+        }
 
+        profile_scope_t profile("build_ir");
         parse_top_level();
 
         model = DEVSMap.at(model_name);
@@ -266,8 +302,16 @@ class AtomicParser {
 
     public:
     std::string model_name;
+    std::string file_name;
+    codegen_options_t options;
 
-    AtomicParser(std::string fileName, std::vector<object_t> _state_set, bool verbose = false) {
+    //! what the experiment logs of this model: ports, state, components, every, interval; null for nothing
+    json log_selection;
+
+    //! conditions ending the simulation once this model satisfies one, see devsmap/stop.hpp; null for none
+    json stop_predicates;
+
+    AtomicParser(std::string fileName, std::vector<object_t> _state_set, bool verbose = false): file_name(fileName) {
 
         parse(fileName);
 
@@ -305,6 +349,262 @@ class AtomicParser {
 
     }
     
+    const std::vector<object_t>& get_state_set() const { return state_set; }
+    const std::vector<object_t>& get_input() const { return input; }
+    const std::vector<object_t>& get_output() const { return output; }
+
+    /**
+     * @brief Adds the input and output ports expression reads to inputs and outputs
+     */
+    void ports_read(const std::string& expression, std::unordered_set<std::string>& inputs, std::unordered_set<std::string>& outputs) {
+        for(auto& token : tokenize_classify(expression)) {
+            if(token.type == TokenType::INPUT_PORT || token.type == TokenType::OUTPUT_PORT) {
+                auto port = token.value.substr(0, token.value.find('.'));
+                (token.type == TokenType::INPUT_PORT ? inputs : outputs).insert(port);
+            }
+        }
+    }
+
+    /**
+     * @brief Static estimate of the work done per event by this model.
+     * Counts every branch and assignment across the transition, output and
+     * time advance trees; used to balance partitions.
+     *
+     * @return size_t
+     */
+    size_t estimated_cost() const {
+        size_t cost = 1;
+        std::function<void(const std::vector<std::shared_ptr<transition_t>>&)> count =
+            [&](const std::vector<std::shared_ptr<transition_t>>& vec) {
+                for(auto& t : vec) {
+                    cost += 1 + t->new_state.size();
+                    count(t->nested);
+                }
+            };
+        std::function<void(const std::vector<std::shared_ptr<ta_t>>&)> count_ta =
+            [&](const std::vector<std::shared_ptr<ta_t>>& vec) {
+                for(auto& t : vec) {
+                    cost += 1;
+                    count_ta(t->nested);
+                }
+            };
+
+        count(dint);
+        count(dext);
+        count(dcon);
+        count(lambda);
+        count_ta(ta);
+
+        return cost;
+    }
+
+    /**
+     * @brief Classifies the time advance from the leaves of the ta tree.
+     * Numeric literals and infinity are constants, leaves that read only
+     * parameters or state no transition writes are PARAMETER, anything
+     * reading written state or ports is STATE_DEPENDENT. A model is CONSTANT or PASSIVE only when every leaf
+     * returns the same literal.
+     *
+     * @return ta_analysis_t
+     */
+    ta_analysis_t analyse_ta() {
+        // state variables no transition assigns keep their initial value
+        std::unordered_set<std::string> written;
+        std::function<void(const std::vector<std::shared_ptr<transition_t>>&)> collect =
+            [&](const std::vector<std::shared_ptr<transition_t>>& vec) {
+                for(auto& t : vec) {
+                    for(auto& state : t->new_state) {
+                        written.insert(state.state_variable);
+                    }
+                    collect(t->nested);
+                }
+            };
+        collect(dint);
+        collect(dext);
+        collect(dcon);
+
+        bool any_parameter = false, any_state = false, any_passive = false, any_finite = false;
+        double min_literal = std::numeric_limits<double>::infinity();
+        double max_literal = 0;
+
+        std::function<void(const std::vector<std::shared_ptr<ta_t>>&)> visit =
+            [&](const std::vector<std::shared_ptr<ta_t>>& vec) {
+                for(auto& t : vec) {
+                    visit(t->nested);
+                    if(t->expression.empty()) {
+                        continue;
+                    }
+
+                    if(is_infinity(t->expression)) {
+                        any_passive = true;
+                    } else if(is_literal(t->expression)) {
+                        double value = std::stod(t->expression);
+                        min_literal = std::min(min_literal, value);
+                        max_literal = std::max(max_literal, value);
+                        any_finite = true;
+                    } else {
+                        // constant expressions that are not a single literal are
+                        // fixed for a run but unknown here, like parameters
+                        bool reads_state = false;
+                        for(auto& token : tokenize_classify(t->expression)) {
+                            bool mutable_state = token.type == TokenType::STATE_VARIABLE && written.count(token.value);
+                            if(mutable_state || token.type == TokenType::INPUT_PORT) {
+                                reads_state = true;
+                            }
+                        }
+                        (reads_state ? any_state : any_parameter) = true;
+                    }
+                }
+            };
+        visit(ta);
+
+        if(any_state) {
+            return ta_analysis_t(TimeAdvanceKind::STATE_DEPENDENT, 0, any_passive, 0);
+        }
+        if(any_parameter) {
+            return ta_analysis_t(TimeAdvanceKind::PARAMETER, 0, any_passive, 0);
+        }
+        if(any_passive && !any_finite) {
+            double inf = std::numeric_limits<double>::infinity();
+            return ta_analysis_t(TimeAdvanceKind::PASSIVE, inf, true, inf);
+        }
+        if(any_finite && !any_passive && min_literal == max_literal) {
+            return ta_analysis_t(TimeAdvanceKind::CONSTANT, min_literal, false, min_literal);
+        }
+
+        // several literals, possibly mixed with infinity: selected by state
+        return ta_analysis_t(TimeAdvanceKind::STATE_DEPENDENT, 0, any_passive, any_finite ? min_literal : 0);
+    }
+
+    /**
+     * @brief Drops ports the experiment never uses.
+     * Assignments to unused output ports leave lambda; branches of delta_ext
+     * and delta_con whose condition needs a message on an unfed input port
+     * (it reads the port's bag, or compares its bagSize() with 0 in a
+     * condition without ||) can never fire and are removed. A port is
+     * removed from the model once nothing reads or writes it; unfed inputs
+     * still read elsewhere, e.g. in an otherwise branch, are kept.
+     *
+     * @param unused_outputs output ports no coupling consumes
+     * @param unfed_inputs input ports no coupling feeds
+     * @return what was removed, one line each
+     */
+    std::vector<std::string> prune_ports(const std::unordered_set<std::string>& unused_outputs, const std::unordered_set<std::string>& unfed_inputs) {
+        std::vector<std::string> report;
+
+        for(auto& port : output) {
+            if(!unused_outputs.count(port.variable)) {
+                continue;
+            }
+            size_t removed = 0;
+            std::function<void(std::vector<std::shared_ptr<transition_t>>&)> strip =
+                [&](std::vector<std::shared_ptr<transition_t>>& vec) {
+                    for(auto& t : vec) {
+                        auto end = std::remove_if(t->new_state.begin(), t->new_state.end(), [&](auto& s) { return s.state_variable == port.variable; });
+                        removed += t->new_state.end() - end;
+                        t->new_state.erase(end, t->new_state.end());
+                        strip(t->nested);
+                    }
+                };
+            strip(lambda);
+            report.push_back(model_name + ": output port " + port.variable + " removed with " + std::to_string(removed) + " lambda assignment(s)");
+        }
+        output.erase(std::remove_if(output.begin(), output.end(), [&](auto& p) { return unused_outputs.count(p.variable); }), output.end());
+
+        if(unfed_inputs.empty()) {
+            return report;
+        }
+
+        auto needs_message = [&](const std::string& condition) -> std::string {
+            if(condition == "otherwise" || condition.find("||") != std::string::npos) {
+                return "";
+            }
+            auto tokens = tokenize_classify(condition);
+            for(size_t i = 0; i < tokens.size(); i++) {
+                if(tokens[i].type != TokenType::INPUT_PORT) {
+                    continue;
+                }
+                auto dot = tokens[i].value.find('.');
+                std::string port = tokens[i].value.substr(0, dot);
+                if(dot == std::string::npos || !unfed_inputs.count(port)) {
+                    continue;
+                }
+                if(tokens[i].value.find(".bag(") != std::string::npos) {
+                    return port;
+                }
+                if(i + 2 < tokens.size() && tokens[i + 2].value == "0" && (tokens[i + 1].value == "!=" || tokens[i + 1].value == ">")) {
+                    return port;
+                }
+            }
+            return "";
+        };
+
+        std::unordered_map<std::string, size_t> dropped;
+        std::function<void(std::vector<std::shared_ptr<transition_t>>&)> drop =
+            [&](std::vector<std::shared_ptr<transition_t>>& vec) {
+                vec.erase(std::remove_if(vec.begin(), vec.end(), [&](auto& t) {
+                    auto port = needs_message(t->condition);
+                    if(!port.empty()) {
+                        dropped[port]++;
+                    }
+                    return !port.empty();
+                }), vec.end());
+                for(auto& t : vec) {
+                    drop(t->nested);
+                }
+            };
+        drop(dext);
+        drop(dcon);
+
+        // what still mentions an input port after the branches are gone
+        std::unordered_set<std::string> read;
+        auto scan = [&](const std::string& text) {
+            for(auto& token : tokenize_classify(text)) {
+                if(token.type == TokenType::INPUT_PORT) {
+                    read.insert(token.value.substr(0, token.value.find('.')));
+                }
+            }
+        };
+        std::function<void(const std::vector<std::shared_ptr<transition_t>>&)> scan_transitions =
+            [&](const std::vector<std::shared_ptr<transition_t>>& vec) {
+                for(auto& t : vec) {
+                    scan(t->condition);
+                    for(auto& state : t->new_state) {
+                        scan(state.expression);
+                    }
+                    scan_transitions(t->nested);
+                }
+            };
+        std::function<void(const std::vector<std::shared_ptr<ta_t>>&)> scan_ta =
+            [&](const std::vector<std::shared_ptr<ta_t>>& vec) {
+                for(auto& t : vec) {
+                    scan(t->condition);
+                    scan(t->expression);
+                    scan_ta(t->nested);
+                }
+            };
+        scan_transitions(dint);
+        scan_transitions(dext);
+        scan_transitions(dcon);
+        scan_transitions(lambda);
+        scan_ta(ta);
+
+        for(auto& port : input) {
+            if(!unfed_inputs.count(port.variable)) {
+                continue;
+            }
+            std::string branches = std::to_string(dropped[port.variable]) + " delta_ext/delta_con branch(es) dropped";
+            if(read.count(port.variable)) {
+                report.push_back(model_name + ": input port " + port.variable + " is never fed but still read, kept; " + branches);
+            } else {
+                report.push_back(model_name + ": input port " + port.variable + " removed, " + branches);
+            }
+        }
+        input.erase(std::remove_if(input.begin(), input.end(), [&](auto& p) { return unfed_inputs.count(p.variable) && !read.count(p.variable); }), input.end());
+
+        return report;
+    }
+
     virtual std::string make_model() = 0;
 
 };
@@ -0,0 +1,459 @@
+/**
+ * Simulation throughput benchmark for DEVSMap generated models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Builds scaled DEVSMap experiments out of the counter and generator atomic
+ * models, generates them with a parser backend, compiles a headless runner
+ * per experiment and collects its throughput. Shapes:
+ *  - wide:    n independent generator -> counter pairs in one coupled model
+ *  - deep:    n nested coupled models, each adding a pair and forwarding the
+ *             inner count through its EOC
+ *  - traffic: one generator fanning out to n counters
+ *  - population: n uncoupled counters; population variants run them through
+ *             the generated counterPopulation instead of n Cadmium objects
+ * Plugin variants load the top model from its shared object (see
+ * PluginBuild.hpp), so comparing their ns_per_transition with a linked
+ * variant of the same flags gives the cost of the plugin boundary.
+ */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "DEVSMap_Parser.hpp"
+#include "UnityBuild.hpp"
+#include "PluginBuild.hpp"
+#include "Validator.hpp"
+
+/////////////////////////////////////BENCHMARK/////////////////////////////////////
+
+struct benchmark_variant_t {
+    std::string name;
+    std::string cxxflags;
+    codegen_options_t options = codegen_options_t();
+    bool population = false;    //!< runs the population shape on counterPopulation
+    bool plugin = false;        //!< loads the top model from its plugin instead of linking it
+};
+
+template<typename AMP, typename CMP>
+class Benchmark {
+    private:
+    std::filesystem::path blocks;
+    std::filesystem::path work;
+    double time_span;
+
+    static json pair_init() {
+        return {
+            {"counter", {{"count", "0"}, {"increment", "1"}, {"countUp", "true"}, {"sigma", "1.0"}}},
+            {"generator", {{"inc", "1"}}}
+        };
+    }
+
+    static json coupled(json x, json y, json components, json ic, json eic, json eoc) {
+        return {
+            {"x", x}, {"y", y}, {"components", components},
+            {"ic", ic}, {"eic", eic}, {"eoc", eoc}
+        };
+    }
+
+    static json ic(const std::string& from, const std::string& port_from, const std::string& to, const std::string& port_to) {
+        return {{"component_from", from}, {"port_from", port_from}, {"component_to", to}, {"port_to", port_to}};
+    }
+
+    static void write_json(const std::filesystem::path& file, const json& content) {
+        std::ofstream out(file);
+        out << content.dump(4) << std::endl;
+    }
+
+    /**
+     * Writes the DEVSMap files of one experiment into dir
+     *
+     * @return the name of the top coupled model
+     */
+    std::string make_experiment(const std::string& shape, size_t n, const std::filesystem::path& dir) {
+        std::filesystem::create_directories(dir);
+        std::filesystem::copy_file(blocks / "counter_atomic.json", dir / "counter_atomic.json", std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::copy_file(blocks / "generator_atomic.json", dir / "generator_atomic.json", std::filesystem::copy_options::overwrite_existing);
+
+        json init = json::object();
+        std::string top;
+        json sets = json::array({"default_sets.json"});
+
+        if(shape == "population") {
+            top = "bench_population";
+            json counters = json::array();
+            json states = json::object();
+            for(size_t i = 0; i < n; i++) {
+                std::string c = "c" + std::to_string(i);
+                counters.push_back(c);
+                states[c] = pair_init()["counter"];
+            }
+
+            json model = coupled(json::object(), json::object(), {{"counter", counters}}, json::array(), json::array(), json::array());
+            write_json(dir / (top + "_coupled.json"), {{top, model}, {"include_sets", sets}});
+            init[top] = states;
+        } else if(shape == "wide" || shape == "traffic") {
+            top = "bench_" + shape;
+            json generators = json::array(), counters = json::array(), couplings = json::array();
+            json states = json::object();
+
+            for(size_t i = 0; i < n; i++) {
+                std::string g = (shape == "wide") ? "g" + std::to_string(i) : "g0";
+                std::string c = "c" + std::to_string(i);
+                if(shape == "wide" || i == 0) {
+                    generators.push_back(g);
+                    states[g] = pair_init()["generator"];
+                }
+                counters.push_back(c);
+                states[c] = pair_init()["counter"];
+                couplings.push_back(ic(g, "inc_out", c, "increment_in"));
+            }
+
+            json model = coupled(json::object(), json::object(), {{"generator", generators}, {"counter", counters}}, couplings, json::array(), json::array());
+            write_json(dir / (top + "_coupled.json"), {{top, model}, {"include_sets", sets}});
+            init[top] = states;
+        } else if(shape == "deep") {
+            for(size_t level = 0; level < n; level++) {
+                std::string name = "bench_deep_" + std::to_string(level);
+                json components = {{"generator", "g"}, {"counter", "c"}};
+                json eoc = json::array();
+
+                if(level == 0) {
+                    eoc.push_back({{"component_from", "c"}, {"port_from", "count_out"}, {"port_to", "count"}});
+                } else {
+                    components["bench_deep_" + std::to_string(level - 1)] = "inner";
+                    eoc.push_back({{"component_from", "inner"}, {"port_from", "count"}, {"port_to", "count"}});
+                }
+
+                json model = coupled(json::object(), {{"count", "int"}}, components, json::array({ic("g", "inc_out", "c", "increment_in")}), json::array(), eoc);
+                write_json(dir / (name + "_coupled.json"), {{name, model}, {"include_sets", sets}});
+                init[name] = {{"g", pair_init()["generator"]}, {"c", pair_init()["counter"]}};
+                top = name;
+            }
+        } else {
+            throw std::runtime_error("UNKNOWN BENCHMARK SHAPE " + shape);
+        }
+
+        write_json(dir / "bench_init_state.json", {{"init_states", init}});
+        write_json(dir / "bench_experiment.json", {
+            {"model_under_test", {{"model", top + "_coupled.json"}, {"initial_state", "bench_init_state.json"}, {"parameters", ""}}},
+            {"experimental_frame", json::object()},
+            {"time_span", std::to_string(time_span)}
+        });
+
+        return top;
+    }
+
+    /**
+     * Headless runner: one silent run for wall time, then one run with a
+     * counting logger (no formatting kept) for the event counts
+     */
+    std::string make_runner(const std::string& top, bool unity, const std::string& plugin = "") const {
+        std::ostringstream oss;
+        std::string make_model = unity ? "make_" + top : "std::make_shared<" + top + ">";
+        if(!plugin.empty()) {
+            make_model = "plugin.create<Coupled>";
+        }
+
+        oss << "#include <chrono>\n#include <cstdio>\n#include <sys/resource.h>\n";
+        if(plugin.empty()) {
+            oss << "#include \"" << (unity ? std::string("devsmap_models") : top) << ".hpp\"\n";
+        } else {
+            oss << "#include \"cadmium/modeling/devs/coupled.hpp\"\n#include \"devsmap/plugin.hpp\"\n";
+        }
+        oss << "#include \"cadmium/simulation/root_coordinator.hpp\"\n";
+        oss << "#include \"cadmium/simulation/logger/logger.hpp\"\n\n";
+        oss << "using namespace cadmium;\n\n";
+
+        oss << "static size_t transitions = 0, messages = 0, events = 0;\n";
+        oss << "static double last_time = -1;\n\n";
+
+        oss << "struct CountingLogger: public Logger {\n";
+        oss << "\tvoid start() override {}\n";
+        oss << "\tvoid stop() override {}\n";
+        oss << "\tvoid logOutput(double, long, const std::string&, const std::string&, const std::string&) override { messages++; }\n";
+        oss << "\tvoid logState(double time, long, const std::string&, const std::string&) override {\n";
+        oss << "\t\ttransitions++;\n";
+        oss << "\t\tif(time != last_time) { events++; last_time = time; }\n";
+        oss << "\t}\n";
+        oss << "};\n\n";
+
+        oss << "int main() {\n";
+        oss << "\tdouble end = " << time_span << ";\n\n";
+        if(!plugin.empty()) {
+            oss << "\tdevsmap::Plugin plugin(\"" << plugin << "\");\n";
+        }
+
+        oss << "\tauto model = " << make_model << "(\"" << top << "\");\n";
+        oss << "\tauto silent = RootCoordinator(model);\n";
+        oss << "\tsilent.start();\n";
+        oss << "\tauto t0 = std::chrono::steady_clock::now();\n";
+        oss << "\tsilent.simulate(end);\n";
+        oss << "\tauto t1 = std::chrono::steady_clock::now();\n";
+        oss << "\tsilent.stop();\n\n";
+
+        oss << "\trusage usage{};\n";
+        oss << "\tgetrusage(RUSAGE_SELF, &usage);\n\n";
+
+        oss << "\tauto counted_model = " << make_model << "(\"" << top << "\");\n";
+        oss << "\tauto counted = RootCoordinator(counted_model);\n";
+        oss << "\tcounted.setLogger<CountingLogger>();\n";
+        oss << "\tcounted.start();\n";
+        oss << "\ttransitions = messages = events = 0;\n";
+        oss << "\tlast_time = -1;\n";
+        oss << "\tcounted.simulate(end);\n";
+        oss << "\tcounted.stop();\n\n";
+
+        oss << "\tdouble seconds = std::chrono::duration<double>(t1 - t0).count();\n";
+        oss << "\tstd::printf(\"{\\\"events\\\": %zu, \\\"transitions\\\": %zu, \\\"messages\\\": %zu, \\\"seconds\\\": %.9f, \\\"peak_rss_kb\\\": %ld}\\n\", events, transitions, messages, seconds, usage.ru_maxrss);\n";
+        oss << "\treturn 0;\n";
+        oss << "}\n";
+
+        return oss.str();
+    }
+
+    /**
+     * Same measurement as make_runner for n counters held by one
+     * counterPopulation: every event is one internal_transitions() sweep
+     */
+    std::string make_population_runner(size_t n) const {
+        std::ostringstream oss;
+
+        oss << "#include <chrono>\n#include <cstdio>\n#include <sys/resource.h>\n";
+        oss << "#include \"counter_population.hpp\"\n\n";
+
+        oss << "int main() {\n";
+        oss << "\tdouble end = " << time_span << ";\n";
+        oss << "\tsize_t transitions = 0, events = 0;\n\n";
+
+        json initial = pair_init()["counter"];
+        oss << "\tcounterState initial{};\n";
+        for(auto& [variable, value] : initial.items()) {
+            oss << "\tinitial." << variable << " = " << value.template get<std::string>() << ";\n";
+        }
+        oss << "\tcounterPopulation population;\n";
+        oss << "\tpopulation.reserve(" << n << ");\n";
+        oss << "\tfor(size_t i = 0; i < " << n << "; i++) {\n";
+        oss << "\t\tpopulation.add(initial);\n";
+        oss << "\t}\n\n";
+
+        oss << "\tauto t0 = std::chrono::steady_clock::now();\n";
+        oss << "\tfor(double t = population.next(); t <= end; t = population.next()) {\n";
+        oss << "\t\ttransitions += population.internal_transitions(t);\n";
+        oss << "\t\tevents++;\n";
+        oss << "\t}\n";
+        oss << "\tauto t1 = std::chrono::steady_clock::now();\n\n";
+
+        oss << "\trusage usage{};\n";
+        oss << "\tgetrusage(RUSAGE_SELF, &usage);\n\n";
+
+        oss << "\tdouble seconds = std::chrono::duration<double>(t1 - t0).count();\n";
+        oss << "\tstd::printf(\"{\\\"events\\\": %zu, \\\"transitions\\\": %zu, \\\"messages\\\": 0, \\\"seconds\\\": %.9f, \\\"peak_rss_kb\\\": %ld}\\n\", events, transitions, seconds, usage.ru_maxrss);\n";
+        oss << "\treturn 0;\n";
+        oss << "}\n";
+
+        return oss.str();
+    }
+
+    static std::string run(const std::string& command) {
+        std::string output;
+        FILE* pipe = popen(command.c_str(), "r");
+        if(!pipe) {
+            return output;
+        }
+        char buffer[4096];
+        while(fgets(buffer, sizeof(buffer), pipe)) {
+            output += buffer;
+        }
+        if(pclose(pipe) != 0) {
+            output.clear();
+        }
+        return output;
+    }
+
+    public:
+    std::vector<std::string> shapes = {"wide", "deep", "traffic", "population"};
+    std::vector<size_t> sizes = {10, 100, 1000};
+    std::vector<benchmark_variant_t> variants = {{"O2", "-O2"}};
+
+    Benchmark(std::filesystem::path _blocks, std::filesystem::path _work, double _time_span = 1000): blocks(_blocks), work(_work), time_span(_time_span) {}
+
+    /**
+     * Generates, compiles and runs every variant x shape x size
+     *
+     * @return one row per run, with the runner's counts and the derived rates
+     */
+    json run_all() {
+        json results = json::array();
+
+        const char* cadmium = std::getenv("CADMIUM");
+        if(!cadmium) {
+            std::cerr << "CADMIUM environment variable not set; cannot compile the runners" << std::endl;
+            return results;
+        }
+        const char* cxx = std::getenv("CXX");
+        std::string runtime_include = runtime_include_dir();
+        if(runtime_include.empty()) {
+            std::cerr << "DEVSMAP_INCLUDE environment variable not set; cannot compile the runners" << std::endl;
+            return results;
+        }
+
+        for(auto& variant : variants) {
+            for(auto& shape : shapes) {
+                if(variant.population && shape != "population") {
+                    continue;
+                }
+                for(auto n : sizes) {
+                    auto dir = work / variant.name / (shape + "_" + std::to_string(n));
+                    std::string top = make_experiment(shape, n, dir / "devsmap");
+
+                    std::error_code err;
+                    std::filesystem::create_directories(dir / "out", err);
+                    std::streambuf* saved = std::cout.rdbuf(nullptr); // generation chatter
+                    Parser<AMP, CMP> parser((dir / "devsmap" / "bench_experiment.json").string(), variant.options);
+                    auto errors = Validator<AMP, CMP>(parser).run();
+                    if(errors.empty()) {
+                        parser.write((dir / "out").string());
+                    }
+                    std::cout.rdbuf(saved);
+                    if(!errors.empty()) {
+                        std::ostringstream error;
+                        error << errors.size() << " validation error(s), first " << errors.front();
+                        results.push_back({{"variant", variant.name}, {"shape", shape}, {"size", n}, {"error", error.str()}});
+                        continue;
+                    }
+                    if(variant.options.unity) {
+                        UnityBuild<AMP, CMP>(parser).write((dir / "out").string());
+                    }
+                    if(variant.plugin) {
+                        PluginBuild<AMP, CMP>(parser).write((dir / "out").string());
+                    }
+
+                    std::ofstream runner(dir / "runner.cpp");
+                    if(variant.population) {
+                        std::ofstream population(dir / "out" / "include" / "counter_population.hpp");
+                        population << parser.atomic("counter")->make_population() << std::endl;
+                        runner << make_population_runner(n);
+                    } else {
+                        runner << make_runner(top, variant.options.unity, variant.plugin ? (dir / (top + ".so")).string() : "");
+                    }
+                    runner.close();
+
+                    std::string compiler = std::string(cxx ? cxx : "c++") + " -std=gnu++2b " + variant.cxxflags + (variant.population ? " -fopenmp-simd -DDEVSMAP_OPENMP_SIMD" : "") +
+                        " -I\"" + (dir / "out" / "include").string() + "\"" +
+                        " -I\"" + runtime_include + "\"" +
+                        " -I\"" + cadmium + "\" -I\"" + cadmium + "/../json/include\"";
+                    auto step = [&](const std::string& arguments) {
+                        return compiler + " " + arguments + " >> \"" + (dir / "compile.log").string() + "\" 2>&1";
+                    };
+                    auto path = [&](const std::string& file) {
+                        return "\"" + (dir / file).string() + "\"";
+                    };
+
+                    // a unity build pays for the PCH and the models once; runner_compile_s is the cost of every later edit
+                    std::vector<std::string> steps;
+                    size_t runner_step;
+                    if(variant.options.unity) {
+                        steps.push_back(step("-x c++-header " + path("out/include/devsmap_pch.hpp") + " -o " + path("out/include/devsmap_pch.hpp.gch")));
+                        steps.push_back(step("-DDEVSMAP_EXTERN_TEMPLATES -c " + path("out/devsmap_models.cpp") + " -o " + path("models.o")));
+                        runner_step = steps.size();
+                        steps.push_back(step("-c " + path("runner.cpp") + " -o " + path("runner.o")));
+                        steps.push_back(step(path("runner.o") + " " + path("models.o") + " -o " + path("runner")));
+                    } else if(variant.plugin) {
+                        steps.push_back(step("-shared -fPIC -fvisibility=hidden " + path("out/plugins/" + top + ".cpp") + " -o " + path(top + ".so")));
+                        runner_step = steps.size();
+                        steps.push_back(step(path("runner.cpp") + " -o " + path("runner") + " -ldl"));
+                    } else {
+                        runner_step = steps.size();
+                        steps.push_back(step(path("runner.cpp") + " -o " + path("runner")));
+                    }
+
+                    bool compiled = true;
+                    double compile_s = 0, runner_compile_s = 0;
+                    for(size_t s = 0; s < steps.size() && compiled; s++) {
+                        auto c0 = std::chrono::steady_clock::now();
+                        compiled = !run(steps[s] + " && echo ok").empty();
+                        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - c0).count();
+                        compile_s += elapsed;
+                        if(s == runner_step) {
+                            runner_compile_s = elapsed;
+                        }
+                    }
+
+                    json row = {{"variant", variant.name}, {"shape", shape}, {"size", n}, {"compile_s", compile_s}, {"runner_compile_s", runner_compile_s}};
+                    if(!compiled) {
+                        row["error"] = "compilation failed, see " + (dir / "compile.log").string();
+                        results.push_back(row);
+                        continue;
+                    }
+
+                    std::string output = run("\"" + (dir / "runner").string() + "\"");
+                    if(output.empty()) {
+                        row["error"] = "runner failed";
+                        results.push_back(row);
+                        continue;
+                    }
+
+                    json measured = json::parse(output);
+                    double seconds = measured["seconds"];
+                    size_t transitions = measured["transitions"];
+                    row.update(measured);
+                    row["events_per_s"] = seconds > 0 ? measured["events"].get<double>() / seconds : 0;
+                    row["transitions_per_s"] = seconds > 0 ? transitions / seconds : 0;
+                    row["ns_per_transition"] = transitions > 0 ? seconds * 1e9 / transitions : 0;
+                    results.push_back(row);
+                }
+            }
+        }
+
+        return results;
+    }
+
+    //! Side by side table, one line per variant, shape and size
+    static void print(const json& results, std::ostream& out) {
+        out << std::left << std::setw(10) << "variant" << std::setw(10) << "shape" << std::setw(8) << "size"
+            << std::right << std::setw(14) << "events/s" << std::setw(16) << "transitions/s"
+            << std::setw(12) << "ns/trans" << std::setw(12) << "rss(kB)" << std::setw(12) << "compile(s)" << std::setw(12) << "runner(s)" << "\n";
+
+        for(auto& row : results) {
+            out << std::left << std::setw(10) << row["variant"].get<std::string>() << std::setw(10) << row["shape"].get<std::string>()
+                << std::setw(8) << row["size"].get<size_t>() << std::right;
+            if(row.contains("error")) {
+                out << "  " << row["error"].get<std::string>() << "\n";
+                continue;
+            }
+            out << std::setw(14) << std::fixed << std::setprecision(0) << row["events_per_s"].get<double>()
+                << std::setw(16) << row["transitions_per_s"].get<double>()
+                << std::setw(12) << std::setprecision(1) << row["ns_per_transition"].get<double>()
+                << std::setw(12) << row["peak_rss_kb"].get<long>()
+                << std::setw(12) << std::setprecision(2) << row["compile_s"].get<double>()
+                << std::setw(12) << row["runner_compile_s"].get<double>() << "\n";
+        }
+    }
+};
+
+#endif //BENCHMARK_HPP
@@ -25,18 +25,99 @@
 #ifndef CADMIUM_ATOMIC_PARSER_HPP
 #define CADMIUM_ATOMIC_PARSER_HPP
 
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <future>
 #include "AtomicParser.hpp"
 
 class CadmiumAtomicParser : public AtomicParser {
     private:
     std::string indent = "";
 
+    //! When set, ports are read and written through this object's members, see fused_ladder()
+    std::string ports_obj;
+
+    //! Branch lists at least this long are split across options.jobs threads
+    static constexpr size_t parallel_branches = 256;
+
+    //! Whether this thread already generates part of a split branch list
+    static inline thread_local bool in_branch_task = false;
+
+    size_t jobs() const {
+        // the profiler records one call tree, so profiled runs stay serial
+        return Profiler::instance().enabled ? 1 : std::max<size_t>(options.jobs, 1);
+    }
+
+    /**
+     * @brief Which branches of a ladder open it with "if" rather than "else if"
+     * 
+     * Worked out up front so each branch can be generated on its own.
+     */
+    template<typename T>
+    static std::vector<bool> opening_branches(const std::vector<std::shared_ptr<T>>& ordered) {
+        std::vector<bool> opens(ordered.size(), false);
+        for(size_t i = 0; i < ordered.size(); i++) {
+            if(!ordered[i]->condition.empty() && ordered[i]->condition != "otherwise") {
+                opens[i] = true;
+                break;
+            }
+        }
+        return opens;
+    }
+
+    /**
+     * @brief Generates count branches with branch(i, out) and joins them in order
+     * 
+     * Long lists are cut into one contiguous range per job, each written to
+     * its own buffer, so the result is byte-identical to generating them one
+     * after another. Branches nested in a split list are generated serially.
+     */
+    template<typename F>
+    std::string generate_branches(size_t count, F branch) {
+        size_t tasks = std::min(jobs(), count / parallel_branches);
+        if(tasks < 2 || in_branch_task) {
+            std::ostringstream oss;
+            for(size_t i = 0; i < count; i++) {
+                branch(i, oss);
+            }
+            return oss.str();
+        }
+
+        std::vector<std::future<std::string>> parts;
+        for(size_t task = 0; task < tasks; task++) {
+            size_t begin = count * task / tasks;
+            size_t end = count * (task + 1) / tasks;
+            parts.push_back(std::async(std::launch::async, [&branch, begin, end]() {
+                in_branch_task = true;
+                std::ostringstream oss;
+                for(size_t i = begin; i < end; i++) {
+                    branch(i, oss);
+                }
+                return oss.str();
+            }));
+        }
+
+        std::string result;
+        for(auto& part : parts) {
+            result += part.get();
+        }
+        return result;
+    }
+
+    std::string port_prefix() const {
+        return ports_obj.empty() ? "" : ports_obj + ".";
+    }
+
     std::string reconstruct_condition(const std::vector<Token>& tokens, 
                                   const std::string& state_obj = "state") {
+    profile_scope_t profile("reconstruct_condition");
     std::ostringstream oss;
 
     std::regex bag_regex(R"((\w+)\.bag\((-?\d+)\))");
     std::regex bagSize_regex(R"((\w+)\.bagSize\(\))");
+    static const std::regex aggregate_regex(R"((\w+)\.bag(Sum|Min|Max)\(\))");
+    static const std::regex predicate_regex(R"((\w+)\.bag(Any|Count)\((.*)\))");
     std::smatch match;
 
     for (auto& token : tokens) {
@@ -54,14 +135,28 @@ class CadmiumAtomicParser : public AtomicParser {
                 break;
 
             case TokenType::INPUT_PORT:
+            case TokenType::OUTPUT_PORT:
                 // Check for bagSize()
                 if (std::regex_match(token.value, match, bagSize_regex)) {
-                    std::string port_name = match[1];
+                    std::string port_name = port_prefix() + std::string(match[1]);
                     oss << port_name << "->getBag().size()";
                 }
+                // Check for bagSum(), bagMin(), bagMax()
+                else if (std::regex_match(token.value, match, aggregate_regex)) {
+                    std::string port_name = port_prefix() + std::string(match[1]);
+                    std::string aggregate = match[2] == "Sum" ? "bag_sum" : match[2] == "Min" ? "bag_min" : "bag_max";
+                    oss << "devsmap::" << aggregate << "(" << port_name << "->getBag())";
+                }
+                // Check for bagAny(cond), bagCount(cond); _ is the message in cond
+                else if (std::regex_match(token.value, match, predicate_regex)) {
+                    std::string port_name = port_prefix() + std::string(match[1]);
+                    std::string aggregate = match[2] == "Any" ? "bag_any" : "bag_count";
+                    std::string cond = reconstruct_condition(tokenize_classify(match[3]), state_obj);
+                    oss << "devsmap::" << aggregate << "(" << port_name << "->getBag(), [&](const auto& _) { return " << cond << "; })";
+                }
                 // Check for bag(index)
                 else if (std::regex_match(token.value, match, bag_regex)) {
-                    std::string port_name = match[1];
+                    std::string port_name = port_prefix() + std::string(match[1]);
                     int index = std::stoi(match[2]);
 
                     if (index >= 0) {
@@ -71,14 +166,10 @@ class CadmiumAtomicParser : public AtomicParser {
                             << port_name << "->getBag().size() - " << -index << ")";
                     }
                 } else {
-                    oss << token.value;
+                    oss << port_prefix() << token.value;
                 }
                 break;
 
-            case TokenType::OUTPUT_PORT:
-                oss << token.value;
-                break;
-
             case TokenType::CONSTANT:
                 oss << token.value;
                 break;
@@ -91,6 +182,67 @@ class CadmiumAtomicParser : public AtomicParser {
     return oss.str();
 }
 
+    /**
+     * @brief Shortest C++ literal that round-trips value
+     */
+    static std::string double_literal(double value) {
+        if(value == std::numeric_limits<double>::infinity()) {
+            return "std::numeric_limits<double>::infinity()";
+        }
+
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        std::string literal(buffer, result.ptr);
+        if(literal.find_first_of(".e") == std::string::npos) {
+            literal += ".0";
+        }
+        return literal;
+    }
+
+    bool ticks() const {
+        return options.time_resolution > 0;
+    }
+
+    /**
+     * @brief Type of times in the generated code, see devsmap/time.hpp
+     */
+    std::string time_type() const {
+        return ticks() ? "devsmap::tick_t" : "double";
+    }
+
+    std::string time_infinity() const {
+        return ticks() ? "devsmap::tick_infinity" : "std::numeric_limits<double>::infinity()";
+    }
+
+    //! Next event time after a transition at last, passive time advances included
+    std::string time_sum(const std::string& last, const std::string& sigma) const {
+        return ticks() ? "devsmap::advance(" + last + ", " + sigma + ")" : last + " + " + sigma;
+    }
+
+    /**
+     * @brief A ta leaf as C++, in ticks when the model counts time in ticks
+     * 
+     * Literals are converted here; other expressions are rounded to the
+     * nearest tick when they are evaluated.
+     */
+    std::string ta_expression(const std::string& expression, const std::string& state_obj) {
+        if(is_infinity(expression)) {
+            return time_infinity();
+        }
+        std::string reconstructed = reconstruct_condition(tokenize_classify(expression), state_obj);
+        if(!ticks()) {
+            return reconstructed;
+        }
+        if(is_literal(expression)) {
+            double value = std::nearbyint(std::stod(expression) * static_cast<double>(options.time_resolution));
+            if(value >= static_cast<double>(std::numeric_limits<int64_t>::max())) {
+                return time_infinity();
+            }
+            return std::to_string(static_cast<int64_t>(value));
+        }
+        return "devsmap::to_ticks(" + reconstructed + ", time_resolution)";
+    }
+
     /**
      * @brief Generates the if-else ladder for the transition functions and the output function
      * 
@@ -98,17 +250,31 @@ class CadmiumAtomicParser : public AtomicParser {
      * @param state_obj 
      * @param transition_flag 
      * @param indent 
+     * @param output_sink when set, outputs are stored in its <port> and <port>_emit members instead of sent
+     * @param written when set, each branch ors the log channels of the state variables it assigns into this variable
      * @return std::string 
      */
     std::string generate_if_else(   const std::vector<std::shared_ptr<transition_t>> vec_transition,
                                     const std::string& state_obj,
                                     const bool transition_flag,
-                                    const std::string& indent = "\t") {
-        std::ostringstream oss;
-        bool first_flag = true;
-        bool only_otherwise = false;
+                                    const std::string& indent = "\t",
+                                    const std::string& output_sink = "",
+                                    const std::string& written = "") {
+        // json objects iterate alphabetically; "otherwise" has to close the ladder
+        auto ordered = vec_transition;
+        std::stable_partition(ordered.begin(), ordered.end(), [](auto& t) { return t->condition != "otherwise"; });
+        auto opens = opening_branches(ordered);
+        std::unordered_map<std::string, uint32_t> channel_of;
+        if(!written.empty()) {
+            for(auto& [bit, name] : log_channels("state")) {
+                channel_of[name] = bit;
+            }
+        }
+
+        return generate_branches(ordered.size(), [&](size_t i, std::ostream& oss) {
+            auto& transition = ordered[i];
+            bool only_otherwise = false;
 
-        for(auto& transition : vec_transition) {
             if (!transition->condition.empty()) {
                 auto tokens = tokenize_classify(transition->condition);
                 std::string processed_condition = reconstruct_condition(tokens, state_obj);
@@ -121,8 +287,7 @@ class CadmiumAtomicParser : public AtomicParser {
                         only_otherwise = true;
                     }
                 } else {
-                    if(first_flag){ //first if, then else if
-                        first_flag = false;
+                    if(opens[i]){ //first if, then else if
                         oss << indent << "if (" << processed_condition << ") {\n";
                     } else {
                         oss << indent << "else if (" << processed_condition << ") {\n";
@@ -138,17 +303,30 @@ class CadmiumAtomicParser : public AtomicParser {
 
                     oss << indent << "\t" << variable << " = " << expression << ";\n";
                 }
+                uint32_t channels = 0;
+                for (const auto& state : transition->new_state) {
+                    auto it = channel_of.find(state.state_variable);
+                    channels |= it == channel_of.end() ? 0 : it->second;
+                }
+                if(channels) {
+                    oss << indent << "\t" << written << " |= " << channels << "u;\n";
+                }
             } else {
                 for (const auto& state : transition->new_state) {
                     auto variable = reconstruct_condition(tokenize_classify(state.state_variable), state_obj);
                     auto expression = reconstruct_condition(tokenize_classify(state.expression), state_obj);
 
-                    oss << indent << "\t" << variable << "->addMessage(" << expression << ");\n";
+                    if(output_sink.empty()) {
+                        oss << indent << "\t" << variable << "->addMessage(" << expression << ");\n";
+                    } else {
+                        oss << indent << "\t" << output_sink << "." << variable << "_emit = true;\n";
+                        oss << indent << "\t" << output_sink << "." << variable << " = " << expression << ";\n";
+                    }
                 }
             }
 
             // Nested conditions
-            oss << generate_if_else(transition->nested, state_obj, transition_flag, indent + "\t");
+            oss << generate_if_else(transition->nested, state_obj, transition_flag, indent + "\t", output_sink, written);
 
             if (!transition->condition.empty()) {
                 if(only_otherwise) {
@@ -157,10 +335,7 @@ class CadmiumAtomicParser : public AtomicParser {
                     oss << indent << "}\n";
                 }
             }
-
-        }
-
-        return oss.str();
+        });
     }
 
     /**
@@ -175,11 +350,15 @@ class CadmiumAtomicParser : public AtomicParser {
     std::string generate_if_else(   const std::vector<std::shared_ptr<ta_t>> vec_transition,
                                     const std::string& state_obj,
                                     const std::string& indent = "\t") {
-        std::ostringstream oss;
-        bool first_flag = true;
-        bool only_otherwise = false;
+        // json objects iterate alphabetically; "otherwise" has to close the ladder
+        auto ordered = vec_transition;
+        std::stable_partition(ordered.begin(), ordered.end(), [](auto& t) { return t->condition != "otherwise"; });
+        auto opens = opening_branches(ordered);
+
+        return generate_branches(ordered.size(), [&](size_t i, std::ostream& oss) {
+            auto& transition = ordered[i];
+            bool only_otherwise = false;
 
-        for(auto& transition : vec_transition) {
             if (!transition->condition.empty()) {
                 auto tokens = tokenize_classify(transition->condition);
                 std::string processed_condition = reconstruct_condition(tokens, state_obj);
@@ -192,8 +371,7 @@ class CadmiumAtomicParser : public AtomicParser {
                         only_otherwise = true;
                     }
                 } else {
-                    if(first_flag){ //first if, then else if
-                        first_flag = false;
+                    if(opens[i]){ //first if, then else if
                         oss << indent << "if (" << processed_condition << ") {\n";
                     } else {
                         oss << indent << "else if (" << processed_condition << ") {\n";
@@ -203,8 +381,7 @@ class CadmiumAtomicParser : public AtomicParser {
 
             
             if(transition->expression != "") {
-                auto expression = reconstruct_condition(tokenize_classify(transition->expression), state_obj);
-                oss << indent << "\treturn " << expression << ";\n";
+                oss << indent << "\treturn " << ta_expression(transition->expression, state_obj) << ";\n";
             }
 
             // Nested conditions
@@ -217,7 +394,124 @@ class CadmiumAtomicParser : public AtomicParser {
                     oss << indent << "}\n";
                 }
             }
+        });
+    }
 
+    /**
+     * @brief Branch-free form of a transition ladder for the population backend
+     * 
+     * Every branch gets a mask (its guard, no earlier sibling taken and its
+     * own condition) and every assignment becomes a select on that mask, so
+     * the ladder is evaluated for all instances alike. Conditions are still
+     * evaluated after the assignments of their parent branch, and only for
+     * the instances reaching them: one that is undefined elsewhere (a
+     * division by zero, say) is never evaluated for an instance not due.
+     * 
+     * @param vec_transition 
+     * @param state_obj 
+     * @param guard mask of the enclosing branch
+     * @param indent 
+     * @param masks number of masks emitted so far, used for fresh names
+     * @return std::string 
+     */
+    std::string generate_masked(    const std::vector<std::shared_ptr<transition_t>>& vec_transition,
+                                    const std::string& state_obj,
+                                    const std::string& guard,
+                                    const std::string& indent,
+                                    size_t& masks) {
+        std::ostringstream oss;
+        std::string taken;
+
+        auto ordered = vec_transition;
+        std::stable_partition(ordered.begin(), ordered.end(), [](auto& t) { return t->condition != "otherwise"; });
+
+        for(auto& transition : ordered) {
+            std::string mask = guard;
+            std::string mask_value;
+            std::string otherwise = taken.empty() ? "" : " && !(" + taken + ")";
+            std::ostringstream body;
+
+            if(transition->condition == "otherwise") {
+                mask = "m" + std::to_string(masks++);
+                mask_value = guard + otherwise;
+            } else if(!transition->condition.empty()) {
+                std::string condition = "c" + std::to_string(masks);
+                mask = "m" + std::to_string(masks++);
+                mask_value = condition;
+                // && short-circuits: the condition is only evaluated where the branch is reached
+                oss << indent << "const bool " << condition << " = " << guard << otherwise << " && (" << reconstruct_condition(tokenize_classify(transition->condition), state_obj) << ");\n";
+                taken += (taken.empty() ? "" : " || ") + condition;
+            }
+
+            for (const auto& state : transition->new_state) {
+                auto variable = reconstruct_condition(tokenize_classify(state.state_variable), state_obj);
+                auto expression = reconstruct_condition(tokenize_classify(state.expression), state_obj);
+
+                body << indent << variable << " = " << mask << " ? (" << expression << ") : " << variable << ";\n";
+            }
+
+            body << generate_masked(transition->nested, state_obj, mask, indent, masks);
+
+            // an empty branch (usually "otherwise {}") needs no mask
+            if(!body.str().empty() && !mask_value.empty()) {
+                oss << indent << "const bool " << mask << " = " << mask_value << ";\n";
+            }
+            oss << body.str();
+        }
+
+        return oss.str();
+    }
+
+    /**
+     * @brief Branch-free form of the time advance ladder, selecting into devsmap_sigma
+     * 
+     * @param vec_transition 
+     * @param state_obj 
+     * @param guard mask of the enclosing branch
+     * @param indent 
+     * @param masks number of masks emitted so far, used for fresh names
+     * @return std::string 
+     */
+    std::string generate_masked(    const std::vector<std::shared_ptr<ta_t>>& vec_transition,
+                                    const std::string& state_obj,
+                                    const std::string& guard,
+                                    const std::string& indent,
+                                    size_t& masks) {
+        std::ostringstream oss;
+        std::string taken;
+
+        auto ordered = vec_transition;
+        std::stable_partition(ordered.begin(), ordered.end(), [](auto& t) { return t->condition != "otherwise"; });
+
+        for(auto& transition : ordered) {
+            std::string mask = guard;
+            std::string mask_value;
+            std::string otherwise = taken.empty() ? "" : " && !(" + taken + ")";
+            std::ostringstream body;
+
+            if(transition->condition == "otherwise") {
+                mask = "m" + std::to_string(masks++);
+                mask_value = guard + otherwise;
+            } else if(!transition->condition.empty()) {
+                std::string condition = "c" + std::to_string(masks);
+                mask = "m" + std::to_string(masks++);
+                mask_value = condition;
+                // && short-circuits: the condition is only evaluated where the branch is reached
+                oss << indent << "const bool " << condition << " = " << guard << otherwise << " && (" << reconstruct_condition(tokenize_classify(transition->condition), state_obj) << ");\n";
+                taken += (taken.empty() ? "" : " || ") + condition;
+            }
+
+            if(transition->expression != "") {
+                auto expression = ta_expression(transition->expression, state_obj);
+                body << indent << "devsmap_sigma = " << mask << " ? static_cast<" << time_type() << ">(" << expression << ") : devsmap_sigma;\n";
+            } else { // a leaf returns, so only branches without an expression go deeper
+                body << generate_masked(transition->nested, state_obj, mask, indent, masks);
+            }
+
+            if(!body.str().empty() && !mask_value.empty()) {
+                oss << indent << "const bool " << mask << " = " << mask_value << ";\n";
+            }
+            oss << body.str();
         }
 
         return oss.str();
@@ -226,6 +520,34 @@ class CadmiumAtomicParser : public AtomicParser {
     public:
     CadmiumAtomicParser(std::string fileName, std::vector<object_t> _state_set, bool flag = false): AtomicParser(fileName, _state_set, flag) {}
 
+    /**
+     * @brief One function of this model inlined into a fused model, see CadmiumCoupledParser::make_fused()
+     * 
+     * State variables are read through state_obj and ports through the
+     * devsmap::wire_t members of ports, so the ladder works on plain
+     * variables instead of Cadmium ports.
+     * 
+     * @param function "delta_int", "delta_ext", "delta_con", "lambda" or "ta"
+     * @return std::string 
+     */
+    std::string fused_ladder(const std::string& function, const std::string& state_obj, const std::string& ports, const std::string& indent) {
+        ports_obj = ports;
+        std::string ladder;
+        if(function == "delta_int") {
+            ladder = generate_if_else(dint, state_obj, true, indent);
+        } else if(function == "delta_ext") {
+            ladder = generate_if_else(dext, state_obj, true, indent);
+        } else if(function == "delta_con") {
+            ladder = generate_if_else(dcon, state_obj, true, indent);
+        } else if(function == "lambda") {
+            ladder = generate_if_else(lambda, state_obj, false, indent);
+        } else if(function == "ta") {
+            ladder = generate_if_else(ta, state_obj, indent);
+        }
+        ports_obj.clear();
+        return ladder;
+    }
+
     std::string make_state() {
         std::string struct_name = model_name + "State";
 
@@ -250,10 +572,13 @@ class CadmiumAtomicParser : public AtomicParser {
             state_struct << ((i < state_set.size() - 1) ? ", " : " {}\n");
         }
 
+        // Value-initialized state, filled field by field by coupled models
+        state_struct << "\t" << struct_name << "() = default;\n";
+
         state_struct << "};\n";
 
         // operator<< overload
-        state_struct << "std::ostream& operator<<(std::ostream& out, const " << struct_name << "& s) {\n";
+        state_struct << "inline std::ostream& operator<<(std::ostream& out, const " << struct_name << "& s) {\n";
         state_struct << "\tout << \"{\"";
         for(size_t i = 0; i < state_set.size(); ++i) {
             state_struct << " << \"" << state_set[i].variable << ":\"" << " << s." << state_set[i].variable;
@@ -264,9 +589,319 @@ class CadmiumAtomicParser : public AtomicParser {
         state_struct << "\treturn out;\n";
         state_struct << "}\n";
 
+        if(options.checkpoint) {
+            state_struct << make_serializers();
+        }
+        if(options.reflect) {
+            state_struct << make_reflection();
+        }
+
         return state_struct.str();
     }
 
+    /**
+     * @brief devsmap::reflection specialization listing the state fields in declaration order
+     * 
+     * @return std::string 
+     */
+    std::string make_reflection() {
+        std::string struct_name = model_name + "State";
+        std::ostringstream oss;
+
+        oss << "static_assert(std::is_standard_layout_v<" << struct_name << ">, \"" << struct_name << " needs a standard layout to be reflected\");\n";
+        oss << "template<>\n";
+        oss << "struct devsmap::reflection<" << struct_name << "> {\n";
+        oss << "\tstatic constexpr std::array<devsmap::field_t, " << state_set.size() << "> fields = {{\n";
+        for(auto& sv : state_set) {
+            oss << "\t\t{\"" << sv.variable << "\", \"" << sv.datatype << "\", offsetof(" << struct_name << ", " << sv.variable << "), sizeof(" << struct_name << "::" << sv.variable << "), devsmap::field_kind<decltype(" << struct_name << "::" << sv.variable << ")>()},\n";
+        }
+        oss << "\t}};\n";
+        oss << "};\n";
+
+        return oss.str();
+    }
+
+    /**
+     * @brief Binary serialize/deserialize of the state, field by field in declaration order
+     * 
+     * @return std::string 
+     */
+    std::string make_serializers() {
+        std::string struct_name = model_name + "State";
+        std::ostringstream oss;
+
+        oss << "inline void serialize(devsmap::SnapshotWriter& out, const " << struct_name << "& s) {\n";
+        for(auto& sv : state_set) {
+            oss << "\tout.write(s." << sv.variable << ");\n";
+        }
+        oss << "}\n";
+
+        oss << "inline void deserialize(devsmap::SnapshotReader& in, " << struct_name << "& s) {\n";
+        for(auto& sv : state_set) {
+            oss << "\tin.read(s." << sv.variable << ");\n";
+        }
+        oss << "}\n";
+
+        return oss.str();
+    }
+
+    struct domain_t {
+        std::string variable;
+        std::string datatype;
+        long long min;
+        size_t size;
+    };
+
+    struct tabulation_t {
+        std::vector<domain_t> domains;
+        size_t states = 1;
+        std::string reason;     //!< why the model is not tabulated, empty when it is
+    };
+
+    bool tabulated = false;
+
+    static bool is_integral(const std::string& datatype) {
+        static const std::unordered_set<std::string> integral = {
+            "short", "unsigned short", "int", "unsigned", "unsigned int", "long", "unsigned long",
+            "long long", "unsigned long long", "size_t", "int8_t", "uint8_t", "int16_t", "uint16_t",
+            "int32_t", "uint32_t", "int64_t", "uint64_t"
+        };
+        return integral.count(datatype) > 0;
+    }
+
+    static bool is_arithmetic(const std::string& datatype) {
+        return datatype == "bool" || datatype == "float" || datatype == "double" || is_integral(datatype);
+    }
+
+    /**
+     * @brief Scalar sets of the model's include_sets files, by name
+     */
+    json load_sets() const {
+        json result = json::object();
+        auto directory = std::filesystem::path(file_name).parent_path();
+        for(auto& set : sets) {
+            std::ifstream file(directory / set);
+            if(!file) {
+                continue;
+            }
+            json contents = json::parse(file);
+            for(auto& [name, value] : contents.items()) {
+                result[name] = value;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Whether delta_int, lambda and ta can be tabulated over every state
+     * 
+     * They must read nothing but state, lambda may send at most one message
+     * per port, and every state variable needs a finite domain: bool, 8-bit integers, or an integer type bounded by an
+     * integer set of the same name in include_sets, e.g.
+     * "level": {"domain": "integer", "min": "0", "max": "3"}.
+     */
+    tabulation_t analyse_tabulation() {
+        tabulation_t result;
+
+        std::string reads;
+        auto check = [&](const std::string& expression, const char* function) {
+            for(auto& token : tokenize_classify(expression)) {
+                if(reads.empty() && (token.type == TokenType::INPUT_PORT || token.type == TokenType::PARAMETER)) {
+                    reads = std::string(function) + " reads " + (token.type == TokenType::INPUT_PORT ? "input port " : "parameter ") + token.value;
+                }
+            }
+        };
+        std::function<void(const std::vector<std::shared_ptr<transition_t>>&, const char*)> visit =
+            [&](const std::vector<std::shared_ptr<transition_t>>& vec, const char* function) {
+                for(auto& t : vec) {
+                    if(t->condition != "otherwise") {
+                        check(t->condition, function);
+                    }
+                    for(auto& state : t->new_state) {
+                        check(state.expression, function);
+                    }
+                    visit(t->nested, function);
+                }
+            };
+        std::function<void(const std::vector<std::shared_ptr<ta_t>>&)> visit_ta =
+            [&](const std::vector<std::shared_ptr<ta_t>>& vec) {
+                for(auto& t : vec) {
+                    if(t->condition != "otherwise") {
+                        check(t->condition, "ta");
+                    }
+                    if(!t->expression.empty() && !is_infinity(t->expression)) {
+                        check(t->expression, "ta");
+                    }
+                    visit_ta(t->nested);
+                }
+            };
+        visit(dint, "delta_int");
+        visit(lambda, "lambda");
+        visit_ta(ta);
+        if(!reads.empty()) {
+            result.reason = reads;
+            return result;
+        }
+
+        for(auto& port : output) {
+            if(!is_arithmetic(port.datatype)) {
+                result.reason = "output port " + port.variable + ": " + port.datatype + " cannot be stored in a table";
+                return result;
+            }
+        }
+
+        // a row holds one message per port; count the sends along each path of the ladder, nested branches included
+        std::string repeated;
+        std::function<void(const std::vector<std::shared_ptr<transition_t>>&, std::unordered_map<std::string, size_t>)> sends =
+            [&](const std::vector<std::shared_ptr<transition_t>>& vec, std::unordered_map<std::string, size_t> sent) {
+                for(auto& t : vec) {
+                    auto path = sent;
+                    for(auto& message : t->new_state) {
+                        if(++path[message.state_variable] > 1 && repeated.empty()) {
+                            repeated = message.state_variable;
+                        }
+                    }
+                    sends(t->nested, path);
+                }
+            };
+        sends(lambda, {});
+        if(!repeated.empty()) {
+            result.reason = "lambda can send more than one message on output port " + repeated;
+            return result;
+        }
+
+        json bounds = load_sets();
+        for(auto& sv : state_set) {
+            domain_t domain{sv.variable, sv.datatype, 0, 0};
+            auto bound = bounds.value(sv.variable, json::object());
+            if(sv.datatype == "bool") {
+                domain.size = 2;
+            } else if(is_integral(sv.datatype) && bound.value("domain", "") == "integer" &&
+                      bound.contains("min") && bound.contains("max") && !is_infinity(bound.at("min").get<std::string>()) &&
+                      !is_infinity(bound.at("max").get<std::string>()) && bound.at("min").get<std::string>() != "-inf") {
+                domain.min = std::stoll(bound.at("min").get<std::string>());
+                long long max = std::stoll(bound.at("max").get<std::string>());
+                if(max < domain.min) {
+                    result.reason = sv.variable + ": empty set, max is below min";
+                    return result;
+                }
+                domain.size = static_cast<size_t>(max - domain.min) + 1;
+            } else if(sv.datatype == "int8_t" || sv.datatype == "uint8_t") {
+                domain.min = sv.datatype == "int8_t" ? -128 : 0;
+                domain.size = 256;
+            } else {
+                result.reason = sv.variable + ": " + sv.datatype + " has no finite domain; bound it with an integer set named " + sv.variable + " in include_sets";
+                return result;
+            }
+
+            if(domain.size > options.tabulate_limit || result.states > options.tabulate_limit / domain.size) {
+                result.reason = "more states than the tabulation limit of " + std::to_string(options.tabulate_limit);
+                return result;
+            }
+            result.states *= domain.size;
+            result.domains.push_back(domain);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief constexpr tables of delta_int, lambda and ta over every state
+     * 
+     * The ladders are emitted as constexpr functions and evaluated by the
+     * compiler into one row per state, so a tabulated transition is an
+     * indexed load. index() maps a state outside the domains to a last row
+     * marked invalid, and a transition leaving them leaves next_valid
+     * unset; both fall back to the ladders.
+     * 
+     * @return std::string 
+     */
+    std::string make_table(const tabulation_t& tabulation) {
+        std::ostringstream oss;
+        std::string state_name = model_name + "State";
+
+        oss << "namespace devsmap_" << model_name << "_table {\n\n";
+        if(ticks()) {
+            oss << "constexpr devsmap::tick_t time_resolution = " << options.time_resolution << ";\n\n";
+        }
+
+        oss << "struct row_t {\n";
+        oss << "\t" << state_name << " next;\n";
+        oss << "\t" << time_type() << " sigma;\n";
+        oss << "\tbool valid;\n";
+        oss << "\tbool next_valid;\n";
+        for(auto& port : output) {
+            oss << "\tbool " << port.variable << "_emit;\n";
+            oss << "\t" << port.datatype << " " << port.variable << ";\n";
+        }
+        oss << "};\n\n";
+
+        oss << "constexpr size_t states = " << tabulation.states << ";\n\n";
+
+        oss << "constexpr bool in_domain(const " << state_name << "& state) {\n";
+        oss << "\treturn true";
+        for(auto& domain : tabulation.domains) {
+            if(domain.datatype != "bool") {
+                oss << " && state." << domain.variable << " >= " << domain.min << "LL && state." << domain.variable << " <= " << domain.min + static_cast<long long>(domain.size) - 1 << "LL";
+            }
+        }
+        oss << ";\n}\n\n";
+
+        oss << "//! Row of a state, states for any state outside the domains\n";
+        oss << "constexpr size_t index(const " << state_name << "& state) {\n";
+        oss << "\tif(!in_domain(state)) {\n\t\treturn states;\n\t}\n";
+        oss << "\treturn 0";
+        size_t stride = 1;
+        for(auto& domain : tabulation.domains) {
+            oss << " + static_cast<size_t>(static_cast<long long>(state." << domain.variable << ") - " << domain.min << "LL) * " << stride;
+            stride *= domain.size;
+        }
+        oss << ";\n}\n\n";
+
+        oss << "constexpr " << state_name << " state_at(size_t i) {\n";
+        oss << "\t" << state_name << " state{};\n";
+        for(auto& domain : tabulation.domains) {
+            if(domain.datatype == "bool") {
+                oss << "\tstate." << domain.variable << " = i % 2 != 0;\n";
+            } else {
+                oss << "\tstate." << domain.variable << " = static_cast<" << domain.datatype << ">(" << domain.min << "LL + static_cast<long long>(i % " << domain.size << "));\n";
+            }
+            oss << "\ti /= " << domain.size << ";\n";
+        }
+        oss << "\treturn state;\n";
+        oss << "}\n\n";
+
+        oss << "constexpr " << time_type() << " time_advance(const " << state_name << "& state) {\n";
+        oss << generate_if_else(ta, "state", "\t");
+        oss << "}\n\n";
+
+        oss << "constexpr std::array<row_t, states + 1> make_rows() {\n";
+        oss << "\tstd::array<row_t, states + 1> rows{};\n";
+        oss << "\tfor(size_t i = 0; i < states; i++) {\n";
+        oss << "\t\tauto& row = rows[i];\n";
+        oss << "\t\tconst " << state_name << " state = state_at(i);\n";
+        oss << "\t\trow.valid = true;\n";
+        oss << "\t\trow.sigma = time_advance(state);\n";
+        oss << generate_if_else(lambda, "state", false, "\t\t", "row");
+        oss << "\t\t" << state_name << " next = state;\n";
+        oss << generate_if_else(dint, "next", true, "\t\t");
+        oss << "\t\trow.next_valid = in_domain(next);\n";
+        oss << "\t\trow.next = next;\n";
+        oss << "\t}\n";
+        oss << "\treturn rows;\n";
+        oss << "}\n\n";
+
+        oss << "inline constexpr std::array<row_t, states + 1> rows = make_rows();\n\n";
+        oss << "} //namespace devsmap_" << model_name << "_table\n\n";
+
+        return oss.str();
+    }
+
+    //! The model's table row for the current state
+    std::string table_row() const {
+        return "\t\tconst auto& devsmap_row = devsmap_" + model_name + "_table::rows[devsmap_" + model_name + "_table::index(state)];\n";
+    }
+
     std::string make_ports() {
         std::ostringstream oss;
 
@@ -277,6 +912,16 @@ class CadmiumAtomicParser : public AtomicParser {
             oss << "\tPort<" << port.datatype << "> " << port.variable << ";\n";
         }
 
+        if(options.reflect) {
+            oss << "\n\tstatic constexpr std::array<devsmap::port_info_t, " << input.size() + output.size() << "> devsmap_ports = {{\n";
+            for(auto* ports : {&input, &output}) {
+                for(auto& port : *ports) {
+                    oss << "\t\t{\"" << port.variable << "\", \"" << port.datatype << "\", sizeof(" << port.datatype << "), devsmap::field_kind<" << port.datatype << ">(), " << (ports == &input ? "true" : "false") << "},\n";
+                }
+            }
+            oss << "\t}};\n";
+        }
+
         oss << std::endl;
 
         //Constructor
@@ -294,15 +939,22 @@ class CadmiumAtomicParser : public AtomicParser {
             oss << ((i < state_set.size() - 1) ? ", " : ")) {\n");
         }
 
+        std::ostringstream add_ports;
         for(auto& port : input) {
-            oss << "\t\t" << port.variable << " = addInPort<" << port.datatype << ">(\"" << port.variable << "\");\n";
+            add_ports << "\t\t" << port.variable << " = addInPort<" << port.datatype << ">(\"" << port.variable << "\");\n";
         }
         for(auto& port : output) {
-            oss << "\t\t" << port.variable << " = addOutPort<" << port.datatype << ">(\"" << port.variable << "\");\n";
+            add_ports << "\t\t" << port.variable << " = addOutPort<" << port.datatype << ">(\"" << port.variable << "\");\n";
         }
 
+        oss << add_ports.str();
         oss << "\t}\n";
 
+        //Constructor from a complete initial state
+        oss << "\t" << model_name << "(const std::string id, const " << model_name << "State& initial): ";
+        oss << "Atomic<" << model_name << "State>(id, initial) {\n";
+        oss << add_ports.str();
+        oss << "\t}\n";
 
         return oss.str();
     }
@@ -311,17 +963,76 @@ class CadmiumAtomicParser : public AtomicParser {
         std::ostringstream oss;
 
         oss << "\tvoid internalTransition(" << model_name << "State& state) const override {\n";
-        oss << generate_if_else(dint, "state", _GLIBCXX_TR1_BETA_FUNCTION_TCC, "\t\t");
+        oss << allocation_scope("internal");
+        if(delta_log()) {
+            oss << "\t\tuint32_t devsmap_written = 0;\n";
+        }
+        if(shadow_clock()) {
+            oss << "\t\tdevsmap_resume = -1;\n";
+            oss << "\t\tdevsmap_elapsed = 0;\n";
+            oss << "\t\tdevsmap_tl += devsmap_sigma;\n";
+        }
+        if(options.trace) {
+            oss << "\t\tdevsmap::trace_scope_t devsmap_trace(devsmap_track, *this, \"internal\", devsmap_tl);\n";
+        }
+        if(tabulated) {
+            oss << table_row();
+            oss << "\t\tif(devsmap_row.next_valid) {\n";
+            oss << "\t\t\tstate = devsmap_row.next;\n";
+            if(delta_log()) {
+                oss << "\t\t\tdevsmap_written = ~0u; // the row replaces the whole state\n";
+            }
+            oss << "\t\t} else {\n";
+            oss << generate_if_else(dint, "state", true, "\t\t\t", "", written());
+            oss << "\t\t}\n";
+        } else {
+            oss << generate_if_else(dint, "state", _GLIBCXX_TR1_BETA_FUNCTION_TCC, "\t\t", "", written());
+        }
+        oss << make_state_log();
+        oss << make_stop_check(false);
         oss << "\t}\n";
 
         return oss.str();
     }
     
+    //! Charges the heap allocations of a generated function to this component, see devsmap/allocations.hpp
+    std::string allocation_scope(const std::string& function) {
+        if(!options.allocations) {
+            return "";
+        }
+        return "\t\tdevsmap::allocation_scope_t devsmap_allocation_scope(devsmap_allocation_site, *this, devsmap::allocation_site_t::" + function + ");\n";
+    }
+
+    //! Rounds e to the tick grid, dropping the drift Cadmium's double clock adds
+    std::string snap_elapsed() {
+        return "\t\te = devsmap::to_time(devsmap::to_ticks(e, time_resolution), time_resolution);\n";
+    }
+
     std::string make_external_transition() {
         std::ostringstream oss;
 
         oss << "\tvoid externalTransition(" << model_name << "State& state, double e) const override {\n";
-        oss << generate_if_else(dext, "state", true, "\t\t");
+        oss << allocation_scope("external");
+        if(delta_log()) {
+            oss << "\t\tuint32_t devsmap_written = 0;\n";
+        }
+        if(shadow_clock()) {
+            oss << "\t\tdevsmap_resume = -1;\n";
+            oss << "\t\te += devsmap_elapsed;\n";
+            oss << "\t\tdevsmap_elapsed = 0;\n";
+        }
+        if(ticks()) {
+            oss << snap_elapsed();
+        }
+        if(shadow_clock()) {
+            oss << "\t\tdevsmap_tl += e;\n";
+        }
+        if(options.trace) {
+            oss << "\t\tdevsmap::trace_scope_t devsmap_trace(devsmap_track, *this, \"external\", devsmap_tl);\n";
+        }
+        oss << generate_if_else(dext, "state", true, "\t\t", "", written());
+        oss << make_state_log();
+        oss << make_stop_check(false);
         oss << "\t}\n";
 
         return oss.str();
@@ -331,7 +1042,25 @@ class CadmiumAtomicParser : public AtomicParser {
         std::ostringstream oss;
 
         oss << "\tvoid confluentTransition(" << model_name << "State& state, double e) const override {\n";
-        oss << generate_if_else(dcon, "state", true, "\t\t");
+        oss << allocation_scope("confluent");
+        if(delta_log()) {
+            oss << "\t\tuint32_t devsmap_written = 0;\n";
+        }
+        if(shadow_clock()) {
+            oss << "\t\te += devsmap_elapsed;\n";
+            oss << "\t\tdevsmap_resume = -1;\n";
+            oss << "\t\tdevsmap_elapsed = 0;\n";
+            oss << "\t\tdevsmap_tl += devsmap_sigma;\n";
+        }
+        if(ticks()) {
+            oss << snap_elapsed();
+        }
+        if(options.trace) {
+            oss << "\t\tdevsmap::trace_scope_t devsmap_trace(devsmap_track, *this, \"confluent\", devsmap_tl);\n";
+        }
+        oss << generate_if_else(dcon, "state", true, "\t\t", "", written());
+        oss << make_state_log();
+        oss << make_stop_check(false);
         oss << "\t}\n";
 
         return oss.str();
@@ -341,7 +1070,26 @@ class CadmiumAtomicParser : public AtomicParser {
         std::ostringstream oss;
 
         oss << "\tvoid output(const " << model_name << "State& state) const override {\n";
-        oss << generate_if_else(lambda, "state", false, "\t\t");
+        oss << allocation_scope("output");
+        if(options.trace) {
+            oss << "\t\tdevsmap::trace_scope_t devsmap_trace(devsmap_track, *this, \"output\", devsmap_tl + devsmap_sigma);\n";
+        }
+        if(tabulated) {
+            oss << table_row();
+            oss << "\t\tif(devsmap_row.valid) {\n";
+            for(auto& port : output) {
+                oss << "\t\t\tif(devsmap_row." << port.variable << "_emit) {\n";
+                oss << "\t\t\t\t" << port.variable << "->addMessage(devsmap_row." << port.variable << ");\n";
+                oss << "\t\t\t}\n";
+            }
+            oss << "\t\t} else {\n";
+            oss << generate_if_else(lambda, "state", false, "\t\t\t");
+            oss << "\t\t}\n";
+        } else {
+            oss << generate_if_else(lambda, "state", false, "\t\t");
+        }
+        oss << make_output_log();
+        oss << make_stop_check(true);
         oss << "\t}\n";
 
         return oss.str();
@@ -350,14 +1098,436 @@ class CadmiumAtomicParser : public AtomicParser {
     std::string make_ta() {
         std::ostringstream oss;
 
-        oss << "\t[[nodiscard]] double timeAdvance(const " << model_name << "State& state) const override {\n";
+        if(shadow_clock() || ticks()) {
+            // the ladder moves to a private function, wrapped to keep the shadow clock or convert ticks
+            std::string ladder = ticks() ? "devsmap_ta_ticks" : "devsmap_time_advance";
+            std::string sigma = ticks() ? "devsmap::to_time(" + ladder + "(state), time_resolution)" : ladder + "(state)";
+
+            oss << "\t[[nodiscard]] double timeAdvance(const " << model_name << "State& state) const override {\n";
+            if(shadow_clock()) {
+                // Cadmium asks again when its simulator starts, so the remaining time holds until the first transition
+                oss << "\t\tif(devsmap_resume >= 0) {\n";
+                oss << "\t\t\treturn devsmap_resume;\n";
+                oss << "\t\t}\n";
+                oss << "\t\tdevsmap_sigma = " << sigma << ";\n";
+                oss << "\t\treturn devsmap_sigma;\n";
+            } else {
+                oss << "\t\treturn " << sigma << ";\n";
+            }
+            oss << "\t}\n\n";
+            oss << "\tprivate:\n";
+            oss << "\t" << time_type() << " " << ladder << "(const " << model_name << "State& state) const {\n";
+        } else {
+            oss << "\t[[nodiscard]] double timeAdvance(const " << model_name << "State& state) const override {\n";
+        }
+        if(tabulated) {
+            oss << table_row();
+            oss << "\t\tif(devsmap_row.valid) {\n";
+            oss << "\t\t\treturn " << "devsmap_row.sigma" << ";\n";
+            oss << "\t\t}\n";
+        }
         oss << generate_if_else(ta, "state", "\t\t");
         oss << "\t}\n";
 
         return oss.str();
     }
+
+    /**
+     * @brief Snapshot members, see devsmap/checkpoint.hpp
+     * 
+     * Cadmium keeps the time of the last transition in its simulators, so the
+     * model tracks it too: restore() turns it back into the remaining time
+     * advance, answered by timeAdvance() until the first transition, and the
+     * elapsed time of the first external transition.
+     * 
+     * @return std::string 
+     */
+    std::string make_checkpoint() {
+        std::ostringstream oss;
+
+        oss << "\tpublic:\n";
+        oss << "\tvoid checkpoint(devsmap::SnapshotWriter& out) const {\n";
+        oss << "\t\tout.begin(getId(), devsmap_tl, devsmap_sigma);\n";
+        oss << "\t\tserialize(out, state);\n";
+        oss << "\t\tout.end();\n";
+        oss << "\t}\n\n";
+
+        oss << "\tvoid restore(devsmap::SnapshotReader& in, double time) {\n";
+        oss << "\t\tin.begin(getId(), devsmap_tl, devsmap_sigma);\n";
+        oss << "\t\tdeserialize(in, state);\n";
+        oss << "\t\tin.end();\n";
+        oss << "\t\tdevsmap_resume = devsmap_tl + devsmap_sigma - time;\n";
+        // rounding can leave an event due at the snapshot time slightly in the past
+        oss << "\t\tif(devsmap_resume < 0) {\n";
+        oss << "\t\t\tdevsmap_resume = 0;\n";
+        oss << "\t\t}\n";
+        oss << "\t\tdevsmap_elapsed = time - devsmap_tl;\n";
+        oss << "\t}\n\n";
+
+        return oss.str();
+    }
+
+    /**
+     * @brief Whether the model keeps its own copy of the simulation clock
+     * 
+     * Needed to checkpoint it and to stamp trace events and log lines with
+     * simulated time.
+     */
+    bool shadow_clock() const {
+        return options.checkpoint || options.trace || logging() || stopping();
+    }
+
+    bool stopping() const {
+        return !stop_predicates.is_null();
+    }
+
+    /**
+     * @brief Checks of the stop predicates reading output ports (outputs) or only state
+     * 
+     * Each is the compiled condition guarding a Stop::request(). The
+     * Validator rejects predicates reading input ports, whose messages are
+     * gone by the time a transition is over.
+     * 
+     * @return std::string 
+     */
+    std::string make_stop_check(bool outputs) {
+        std::ostringstream oss;
+        if(!stopping()) {
+            return "";
+        }
+
+        for(auto& predicate : stop_predicates) {
+            auto expression = predicate.get<std::string>();
+            auto tokens = tokenize_classify(expression);
+            if(std::any_of(tokens.begin(), tokens.end(), [](auto& t) { return t.type == TokenType::OUTPUT_PORT; }) != outputs) {
+                continue;
+            }
+
+            std::string quoted;
+            for(char c : expression) {
+                if(c == '"' || c == '\\') {
+                    quoted += '\\';
+                }
+                quoted += c;
+            }
+            oss << "\t\tif(" << reconstruct_condition(tokens, "state") << ") {\n";
+            oss << "\t\t\tdevsmap::Stop::instance().request(" << (outputs ? "devsmap_tl + devsmap_sigma" : "devsmap_tl") << ", *this, \"" << quoted << "\");\n";
+            oss << "\t\t}\n";
+        }
+
+        return oss.str();
+    }
+
+    bool logging() const {
+        return !log_selection.is_null();
+    }
+
+    //! Whether state lines only carry what the transition assigned, between full keyframes
+    bool delta_log() const {
+        return logging() && log_selection.value("keyframe", 0) > 0 && !log_channels("state").empty();
+    }
+
+    //! Variable the transition branches record their assignments in, empty without delta logging
+    std::string written() const {
+        return delta_log() ? "devsmap_written" : "";
+    }
+
+    /**
+     * @brief Logged channels of the model, output ports first, see devsmap/log.hpp
+     * 
+     * The selection was checked by Validator::validate_logs().
+     * 
+     * @param kind "port" or "state", both when empty
+     * @return channel bit and name of each
+     */
+    std::vector<std::pair<uint32_t, std::string>> log_channels(const std::string& kind = "") const {
+        std::vector<std::pair<uint32_t, std::string>> channels;
+        if(!logging()) {
+            return channels;
+        }
+        uint32_t bit = 1;
+        for(auto& port : log_selection.value("ports", json::array())) {
+            auto name = port.get<std::string>();
+            if(kind != "state") {
+                channels.emplace_back(bit, name);
+            }
+            bit <<= 1;
+        }
+        for(auto& variable : log_selection.value("state", json::array())) {
+            auto name = variable.get<std::string>();
+            if(kind != "port") {
+                channels.emplace_back(bit, name);
+            }
+            bit <<= 1;
+        }
+        return channels;
+    }
+
+    std::string make_log_members() {
+        std::ostringstream oss;
+        uint32_t all = 0;
+        for(auto& [bit, _] : log_channels()) {
+            all |= bit;
+        }
+
+        oss << "\tstatic constexpr devsmap::log_selection_t devsmap_log_selection[] = {";
+        if(log_selection.contains("components")) {
+            auto& components = log_selection.at("components");
+            for(size_t i = 0; i < components.size(); i++) {
+                oss << (i ? ", " : "") << "{\"" << components[i].get<std::string>() << "\", " << all << "u}";
+            }
+        } else {
+            oss << "{nullptr, " << all << "u}";
+        }
+        oss << "};\n";
+
+        oss << "\tstatic constexpr devsmap::log_sampling_t devsmap_log_sampling{" << log_selection.value("every", 1) << ", " << double_literal(log_selection.value("interval", 0.0)) << "};\n";
+        oss << "\tmutable devsmap::log_point_t devsmap_log_output;\n";
+        oss << "\tmutable devsmap::log_point_t devsmap_log_state;\n";
+
+        return oss.str();
+    }
+
+    /**
+     * @brief Writes the selected state variables after a transition; nothing
+     * when no state variable is selected
+     */
+    std::string make_state_log() {
+        std::ostringstream oss;
+        auto channels = log_channels("state");
+        if(channels.empty()) {
+            return "";
+        }
+
+        std::string kind = "\"state\"";
+        if(delta_log()) {
+            oss << "\t\tdevsmap_log_state.assign(devsmap_written);\n";
+        }
+        oss << "\t\tif(auto devsmap_channels = devsmap_log_state.sample(*this, devsmap_log_selection, devsmap_log_sampling, devsmap_tl)) {\n";
+        if(delta_log()) {
+            kind = "devsmap_kind";
+            oss << "\t\t\tconst bool devsmap_keyframe = devsmap_log_state.keyframe(" << log_selection.at("keyframe").get<uint64_t>() << ");\n";
+            oss << "\t\t\tconst char* devsmap_kind = devsmap_keyframe ? \"keyframe\" : \"state\";\n";
+            oss << "\t\t\tdevsmap_channels = devsmap_log_state.delta(devsmap_channels, devsmap_keyframe);\n";
+        }
+        for(auto& [bit, name] : channels) {
+            oss << "\t\t\tif(devsmap_channels & " << bit << "u) {\n";
+            oss << "\t\t\t\tdevsmap::Log::instance().write(devsmap_tl, devsmap_log_state.path(), " << kind << ", \"" << name << "\", state." << name << ");\n";
+            oss << "\t\t\t}\n";
+        }
+        oss << "\t\t}\n";
+
+        return oss.str();
+    }
+
+    std::string make_output_log() {
+        std::ostringstream oss;
+        auto channels = log_channels("port");
+        if(channels.empty()) {
+            return "";
+        }
+
+        oss << "\t\tif(auto devsmap_channels = devsmap_log_output.sample(*this, devsmap_log_selection, devsmap_log_sampling, devsmap_tl + devsmap_sigma)) {\n";
+        for(auto& [bit, name] : channels) {
+            oss << "\t\t\tif(devsmap_channels & " << bit << "u) {\n";
+            oss << "\t\t\t\tfor(auto& devsmap_message : " << name << "->getBag()) {\n";
+            oss << "\t\t\t\t\tdevsmap::Log::instance().write(devsmap_tl + devsmap_sigma, devsmap_log_output.path(), \"port\", \"" << name << "\", devsmap_message);\n";
+            oss << "\t\t\t\t}\n";
+            oss << "\t\t\t}\n";
+        }
+        oss << "\t\t}\n";
+
+        return oss.str();
+    }
+
+    /**
+     * @brief Shadow clock members, and the trace track when tracing
+     * 
+     * @return std::string 
+     */
+    std::string make_shadow_clock() {
+        std::ostringstream oss;
+
+        oss << "\tprivate:\n";
+        oss << "\tmutable double devsmap_tl = 0;\n";
+        oss << "\tmutable double devsmap_sigma = 0;\n";
+        oss << "\tmutable double devsmap_resume = -1;\n";
+        oss << "\tmutable double devsmap_elapsed = 0;\n";
+        if(options.trace) {
+            oss << "\tmutable devsmap::trace_track_t devsmap_track;\n";
+        }
+        if(logging()) {
+            oss << make_log_members();
+        }
+
+        return oss.str();
+    }
     
+    /**
+     * @brief Static constexpr members describing the time advance, see devsmap/traits.hpp
+     *
+     * @return std::string
+     */
+    std::string make_ta_traits() {
+        std::ostringstream oss;
+        auto analysis = analyse_ta();
+
+        oss << "\tstatic constexpr devsmap::TimeAdvance ta_kind = devsmap::TimeAdvance::" << analysis.kind << ";\n";
+        oss << "\tstatic constexpr double ta_constant = " << double_literal(analysis.constant) << ";\n";
+        oss << "\tstatic constexpr bool ta_may_passivate = " << (analysis.may_passivate ? "true" : "false") << ";\n";
+        oss << "\tstatic constexpr double ta_min_lookahead = " << double_literal(analysis.min_lookahead) << ";\n";
+        if(ticks()) {
+            oss << "\tstatic constexpr devsmap::tick_t time_resolution = " << options.time_resolution << ";\n";
+        }
+
+        return oss.str();
+    }
+
+    /**
+     * @brief <model>Population: every instance of the model in one object
+     * 
+     * Each state variable is a contiguous array (bools as uint8_t) next to the
+     * array of next event times. internal_transitions(t) runs the internal
+     * transition and the time advance of all instances in one loop, masked
+     * by devsmap_tn == t, so the compiler can vectorize it (the min reduction
+     * on the next event time needs -fopenmp, or -fopenmp-simd with
+     * DEVSMAP_OPENMP_SIMD defined; the pragma is left out otherwise). Output
+     * and external transitions stay with the Cadmium class; get() and set()
+     * move single instances between the two, in constant time: the soonest
+     * next event time is only rescanned, by next(), after set() delayed the
+     * instance that held it. With a time resolution, times are ticks.
+     * 
+     * @return std::string 
+     */
+    std::string make_population() {
+        profile_scope_t profile("emit_population");
+        std::ostringstream oss;
+        std::string class_name = model_name + "Population";
+        std::string state_name = model_name + "State";
+
+        std::string MODEL_NAME = model_name;
+        std::transform(MODEL_NAME.begin(), MODEL_NAME.end(), MODEL_NAME.begin(), ::toupper);
+
+        auto storage = [](const std::string& datatype) {
+            return datatype == "bool" ? std::string("uint8_t") : datatype;
+        };
+
+        oss << "#ifndef __DEVSMAP__PARSER__" << MODEL_NAME << "_POPULATION__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__" << MODEL_NAME << "_POPULATION__HPP__\n\n";
+        oss << "#include <algorithm>\n#include <cstdint>\n#include <limits>\n#include <vector>\n#include \"" << model_name << ".hpp\"\n\n";
+
+        oss << "class " << class_name << " {\n\n";
+        oss << "\tmutable " << time_type() << " devsmap_soonest = " << time_infinity() << ";\n";
+        oss << "\tmutable bool devsmap_stale = false;     //!< devsmap_soonest may be earlier than every devsmap_tn\n\n";
+        oss << "\tpublic:\n\n";
+        if(ticks()) {
+            oss << "\tstatic constexpr devsmap::tick_t time_resolution = " << model_name << "::time_resolution;\n\n";
+        }
+
+        for(auto& sv : state_set) {
+            oss << "\tstd::vector<" << storage(sv.datatype) << "> " << sv.variable << ";\n";
+        }
+        oss << "\tstd::vector<" << time_type() << "> devsmap_tn;   //!< next event time of each instance\n\n";
+
+        oss << "\tsize_t size() const {\n\t\treturn devsmap_tn.size();\n\t}\n\n";
+
+        oss << "\tvoid reserve(size_t n) {\n";
+        for(auto& sv : state_set) {
+            oss << "\t\t" << sv.variable << ".reserve(n);\n";
+        }
+        oss << "\t\tdevsmap_tn.reserve(n);\n";
+        oss << "\t}\n\n";
+
+        oss << "\tstatic " << time_type() << " time_advance(const " << state_name << "& s) {\n";
+        oss << "\t\t" << time_type() << " devsmap_sigma = " << time_infinity() << ";\n";
+        size_t masks = 0;
+        oss << generate_masked(ta, "s", "true", "\t\t", masks);
+        oss << "\t\treturn devsmap_sigma;\n";
+        oss << "\t}\n\n";
+
+        oss << "\t//! Adds an instance whose last transition happened at time t, returns its index\n";
+        oss << "\tsize_t add(const " << state_name << "& s, " << time_type() << " t = 0) {\n";
+        for(auto& sv : state_set) {
+            oss << "\t\t" << sv.variable << ".push_back(s." << sv.variable << ");\n";
+        }
+        oss << "\t\tdevsmap_tn.push_back(" << time_sum("t", "time_advance(s)") << ");\n";
+        oss << "\t\tdevsmap_soonest = std::min(devsmap_soonest, devsmap_tn.back());\n";
+        oss << "\t\treturn devsmap_tn.size() - 1;\n";
+        oss << "\t}\n\n";
+
+        oss << "\t" << state_name << " get(size_t i) const {\n";
+        oss << "\t\t" << state_name << " s{};\n";
+        for(auto& sv : state_set) {
+            oss << "\t\ts." << sv.variable << " = " << sv.variable << "[i];\n";
+        }
+        oss << "\t\treturn s;\n";
+        oss << "\t}\n\n";
+
+        oss << "\t//! Replaces the state of instance i after a transition at time t\n";
+        oss << "\tvoid set(size_t i, const " << state_name << "& s, " << time_type() << " t) {\n";
+        for(auto& sv : state_set) {
+            oss << "\t\t" << sv.variable << "[i] = s." << sv.variable << ";\n";
+        }
+        oss << "\t\tconst " << time_type() << " devsmap_previous = devsmap_tn[i];\n";
+        oss << "\t\tdevsmap_tn[i] = " << time_sum("t", "time_advance(s)") << ";\n";
+        oss << "\t\tif(devsmap_tn[i] <= devsmap_soonest) {\n";
+        oss << "\t\t\tdevsmap_soonest = devsmap_tn[i];\n";
+        oss << "\t\t\tdevsmap_stale = false;\n";
+        oss << "\t\t} else if(devsmap_previous == devsmap_soonest) {\n";
+        oss << "\t\t\tdevsmap_stale = true; // it may have been the only instance that soon\n";
+        oss << "\t\t}\n";
+        oss << "\t}\n\n";
+
+        oss << "\t" << time_type() << " next() const {\n";
+        oss << "\t\tif(devsmap_stale) {\n";
+        oss << "\t\t\tdevsmap_soonest = devsmap_tn.empty() ? " << time_infinity() << " : *std::min_element(devsmap_tn.begin(), devsmap_tn.end());\n";
+        oss << "\t\t\tdevsmap_stale = false;\n";
+        oss << "\t\t}\n";
+        oss << "\t\treturn devsmap_soonest;\n";
+        oss << "\t}\n\n";
+
+        oss << "\t//! Internal transitions of every instance due at t, returns how many were due\n";
+        oss << "\tsize_t internal_transitions(" << time_type() << " t) {\n";
+        oss << "\t\tconst size_t devsmap_n = devsmap_tn.size();\n";
+        oss << "\t\tsize_t devsmap_due_count = 0;\n";
+        oss << "\t\t" << time_type() << " devsmap_next = " << time_infinity() << ";\n";
+        // raw pointers: a store through uint8_t* could alias the vectors' own members otherwise
+        for(auto& sv : state_set) {
+            oss << "\t\t" << storage(sv.datatype) << "* __restrict devsmap_p_" << sv.variable << " = " << sv.variable << ".data();\n";
+        }
+        oss << "\t\t" << time_type() << "* __restrict devsmap_p_tn = devsmap_tn.data();\n";
+        oss << "\t\t#if defined(_OPENMP) || defined(DEVSMAP_OPENMP_SIMD)\n";
+        oss << "\t\t#pragma omp simd reduction(min:devsmap_next) reduction(+:devsmap_due_count)\n";
+        oss << "\t\t#endif\n";
+        oss << "\t\tfor(size_t i = 0; i < devsmap_n; i++) {\n";
+        oss << "\t\t\tconst bool devsmap_due = devsmap_p_tn[i] == t;\n";
+        oss << "\t\t\t" << state_name << " s{};\n";
+        for(auto& sv : state_set) {
+            oss << "\t\t\ts." << sv.variable << " = devsmap_p_" << sv.variable << "[i];\n";
+        }
+        masks = 0;
+        oss << generate_masked(dint, "s", "devsmap_due", "\t\t\t", masks);
+        for(auto& sv : state_set) {
+            oss << "\t\t\tdevsmap_p_" << sv.variable << "[i] = s." << sv.variable << ";\n";
+        }
+        oss << "\t\t\tconst " << time_type() << " devsmap_sigma = time_advance(s);\n";
+        oss << "\t\t\tdevsmap_p_tn[i] = devsmap_due ? " << time_sum("t", "devsmap_sigma") << " : devsmap_p_tn[i];\n";
+        oss << "\t\t\tdevsmap_next = devsmap_p_tn[i] < devsmap_next ? devsmap_p_tn[i] : devsmap_next;\n";
+        oss << "\t\t\tdevsmap_due_count += devsmap_due;\n";
+        oss << "\t\t}\n";
+        oss << "\t\tdevsmap_soonest = devsmap_next;\n";
+        oss << "\t\tdevsmap_stale = false;\n";
+        oss << "\t\treturn devsmap_due_count;\n";
+        oss << "\t}\n";
+
+        oss << "};\n\n";
+        oss << "#endif //__DEVSMAP__PARSER__" << MODEL_NAME << "_POPULATION__HPP__\n";
+
+        return oss.str();
+    }
+
     std::string make_model() {
+        profile_scope_t profile("emit");
         std::ostringstream oss;
 
         std::string MODEL_NAME = model_name;
@@ -365,25 +1535,103 @@ class CadmiumAtomicParser : public AtomicParser {
 
         oss << "#ifndef __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
         oss << "#define __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n\n";
-        oss << "#include <iostream>\n#include \"cadmium/modeling/devs/atomic.hpp\"\n\n";
+        oss << "#include <iostream>\n#include <limits>\n#include \"cadmium/modeling/devs/atomic.hpp\"\n#include \"devsmap/traits.hpp\"\n";
+        if(options.checkpoint) {
+            oss << "#include \"devsmap/checkpoint.hpp\"\n";
+        }
+        if(ticks()) {
+            oss << "#include \"devsmap/time.hpp\"\n";
+        }
+        if(options.tabulate) {
+            oss << "#include <array>\n";
+        }
+        if(options.reflect) {
+            oss << "#include \"devsmap/reflection.hpp\"\n";
+        }
+        if(options.trace || logging() || options.allocations || stopping()) {
+            // component paths walk up through the parents
+            oss << "#include \"cadmium/modeling/devs/coupled.hpp\"\n";
+        }
+        if(options.trace) {
+            oss << "#include \"devsmap/trace.hpp\"\n";
+        }
+        if(options.allocations) {
+            oss << "#include \"devsmap/allocations.hpp\"\n";
+        }
+        if(uses_bag_aggregates()) {
+            oss << "#include \"devsmap/bag.hpp\"\n";
+        }
+        if(logging()) {
+            oss << "#include \"devsmap/log.hpp\"\n";
+        }
+        if(stopping()) {
+            oss << "#include \"devsmap/stop.hpp\"\n";
+        }
+        oss << "\n";
 
         oss << "using namespace cadmium;\n\n";
 
         oss << make_state() << std::endl;
 
+        if(options.state_budget > 0) {
+            oss << "static_assert(sizeof(" << model_name << "State) <= " << options.state_budget << ", \"" << model_name << "State exceeds the state budget of " << options.state_budget << " bytes\");\n\n";
+        }
+
+        if(options.tabulate) {
+            auto tabulation = analyse_tabulation();
+            tabulated = tabulation.reason.empty();
+            if(tabulated) {
+                oss << "// tabulated: " << tabulation.states << " states (";
+                for(size_t i = 0; i < tabulation.domains.size(); i++) {
+                    oss << (i ? " x " : "") << tabulation.domains[i].variable << " " << tabulation.domains[i].size;
+                }
+                oss << ")\n";
+                oss << make_table(tabulation);
+            } else {
+                oss << "// not tabulated: " << tabulation.reason << "\n\n";
+                std::cerr << "NOT TABULATED " << model_name << ": " << tabulation.reason << std::endl;
+            }
+        }
+
         oss << "class " << model_name << ": public Atomic<" << model_name << "State>{\n\n";
         oss << "\tpublic:\n\n";
+
+        oss << make_ta_traits() << std::endl;
         
         oss << make_ports() << std::endl; //also constructor
 
-        oss << make_internal_transition() << std::endl;
-        oss << make_external_transition() << std::endl;
-        oss << make_confluent_transition() << std::endl;
-        oss << make_lambda() << std::endl;
-        oss << make_ta() << std::endl;
+        // the functions only read the model, so they can be generated side by side
+        auto launch = jobs() > 1 ? std::launch::async : std::launch::deferred;
+        std::future<std::string> functions[] = {
+            std::async(launch, [this]() { return make_internal_transition(); }),
+            std::async(launch, [this]() { return make_external_transition(); }),
+            std::async(launch, [this]() { return make_confluent_transition(); }),
+            std::async(launch, [this]() { return make_lambda(); }),
+            std::async(launch, [this]() { return make_ta(); })
+        };
+        for(auto& function : functions) {
+            oss << function.get() << std::endl;
+        }
+
+        if(options.checkpoint) {
+            oss << make_checkpoint();
+        }
+        if(shadow_clock()) {
+            oss << make_shadow_clock();
+        }
+        if(options.allocations) {
+            oss << "\tprivate:\n";
+            oss << "\tmutable devsmap::allocation_site_t devsmap_allocation_site;\n";
+        }
 
         oss << "};\n\n";
 
+        if(options.unity) {
+            oss << "#ifdef DEVSMAP_EXTERN_TEMPLATES\n";
+            oss << "extern template class cadmium::Atomic<" << model_name << "State>;\n";
+            oss << "#endif\n\n";
+        }
+
         oss << "#endif //__DEVSMAP__PARSER__" << MODEL_NAME << "_HPP__\n";
 
         return oss.str();
@@ -21,6 +21,9 @@
 #ifndef CADMIUM_COUPLED_PARSER_HPP
 #define CADMIUM_COUPLED_PARSER_HPP
 
+#include <charconv>
+#include <functional>
+#include <unordered_set>
 #include "CoupledParser.hpp"
 #include "CadmiumAtomicParser.hpp"
 
@@ -29,7 +32,738 @@ class CadmiumCoupledParser : public CoupledParser {
     std::string indent = "";
     std::string file_path;
 
+    /**
+     * A group of atomic components generated as one atomic model. Member
+     * ports coupled outside the group become its ports, named
+     * <component>_<port>.
+     */
+    struct fusion_t {
+        std::string model;
+        std::string component;
+        std::vector<component_t> members;
+        std::vector<std::pair<port_t, object_t>> inputs;    //!< member port, fused port
+        std::vector<std::pair<port_t, object_t>> outputs;
+    };
+
+    std::vector<fusion_t> fusions;
+
+    /**
+     * Components with the same constant time advance and no input coupled,
+     * generated as one atomic that runs all of them at every period
+     */
+    struct bucket_t {
+        std::string model;
+        std::string component;
+        double period;
+        std::vector<component_t> members;
+    };
+
+    std::vector<bucket_t> buckets;
+
+    const bucket_t* bucket_of(const std::string& component) const {
+        for(auto& bucket : buckets) {
+            for(auto& member : bucket.members) {
+                if(member.component_name == component) {
+                    return &bucket;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief The atomic model running the members of bucket
+     * 
+     * Members never receive input and always wait the same time, so they
+     * all fire at every multiple of the period: one internal transition
+     * runs every member's internal transition in a loop, one output runs
+     * every output function. The member states are kept per model in
+     * vectors; every member output port is a port of the bucket, named
+     * <component>_<port>.
+     * 
+     * @return std::string 
+     */
+    template<typename Atomics>
+    std::string make_bucket(const bucket_t& bucket, const Atomics& atomics) const {
+        std::ostringstream oss;
+        std::string state_name = bucket.model + "State";
+        std::string MODEL_NAME = bucket.model;
+        std::transform(MODEL_NAME.begin(), MODEL_NAME.end(), MODEL_NAME.begin(), ::toupper);
+
+        std::vector<std::string> models;
+        for(auto& member : bucket.members) {
+            if(std::find(models.begin(), models.end(), member.model_name) == models.end()) {
+                models.push_back(member.model_name);
+            }
+        }
+
+        char period[32];
+        std::string period_literal(period, std::to_chars(period, period + sizeof(period), bucket.period).ptr);
+        if(period_literal.find_first_of(".e") == std::string::npos) {
+            period_literal += ".0";
+        }
+
+        oss << "#ifndef __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n\n";
+        oss << "#include <iostream>\n#include <limits>\n#include <string>\n#include <vector>\n#include \"cadmium/modeling/devs/atomic.hpp\"\n";
+        for(auto& model : models) {
+            oss << "#include \"" << model << ".hpp\"\n";
+        }
+        oss << "\nusing namespace cadmium;\n\n";
+
+        oss << "// " << bucket.members.size() << " components of " << model_name << " firing every " << period_literal << "\n";
+        oss << "struct " << state_name << " {\n";
+        for(auto& model : models) {
+            oss << "\tstd::vector<" << model << "State> " << model << ";\n";
+        }
+        oss << "};\n";
+        oss << "inline std::ostream& operator<<(std::ostream& out, const " << state_name << "& s) {\n";
+        oss << "\tout << \"{\";\n";
+        for(size_t m = 0; m < models.size(); m++) {
+            oss << "\tout << \"" << (m ? ", " : "") << models[m] << ":[\";\n";
+            oss << "\tfor(size_t i = 0; i < s." << models[m] << ".size(); i++) {\n";
+            oss << "\t\tout << (i ? \", \" : \"\") << s." << models[m] << "[i];\n";
+            oss << "\t}\n";
+            oss << "\tout << \"]\";\n";
+        }
+        oss << "\treturn out << \"}\";\n";
+        oss << "}\n\n";
+
+        oss << "class " << bucket.model << ": public Atomic<" << state_name << ">{\n\n";
+        oss << "\tprivate:\n";
+        for(auto& model : models) {
+            auto& atomic = atomics.at(model);
+            oss << "\tstruct devsmap_" << model << "_ports_t {\n";
+            for(auto& port : atomic->get_output()) {
+                oss << "\t\tPort<" << port.datatype << "> " << port.variable << ";\n";
+            }
+            oss << "\t};\n";
+            oss << "\tstd::vector<devsmap_" << model << "_ports_t> devsmap_" << model << ";\n";
+            oss << "\tstatic constexpr const char* devsmap_" << model << "_components[] = {";
+            bool first = true;
+            for(auto& member : bucket.members) {
+                if(member.model_name == model) {
+                    oss << (first ? "" : ", ") << "\"" << member.component_name << "\"";
+                    first = false;
+                }
+            }
+            oss << "};\n\n";
+        }
+
+        oss << "\tvoid devsmap_add_ports() {\n";
+        for(auto& model : models) {
+            oss << "\t\tfor(std::string id : devsmap_" << model << "_components) {\n";
+            oss << "\t\t\tdevsmap_" << model << ".push_back({";
+            bool first = true;
+            for(auto& port : atomics.at(model)->get_output()) {
+                oss << (first ? "" : ", ") << "addOutPort<" << port.datatype << ">(id + \"_" << port.variable << "\")";
+                first = false;
+            }
+            oss << "});\n";
+            oss << "\t\t}\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\t//! Member states as the coupled model initializes them, in component order\n";
+        oss << "\tstatic " << state_name << " devsmap_initial() {\n";
+        oss << "\t\t" << state_name << " initial{};\n";
+        for(auto& member : bucket.members) {
+            json init = component_init(member);
+            oss << "\t\t{\n";
+            oss << "\t\t\t" << member.model_name << "State s{};\n";
+            if(init.is_object()) {
+                for(auto& [variable, value] : init.items()) {
+                    oss << "\t\t\ts." << variable << " = " << state_value(value) << ";\n";
+                }
+            }
+            oss << "\t\t\tinitial." << member.model_name << ".push_back(s);\n";
+            oss << "\t\t}\n";
+        }
+        oss << "\t\treturn initial;\n";
+        oss << "\t}\n\n";
+
+        oss << "\tpublic:\n";
+        oss << "\tstatic constexpr double period = " << period_literal << ";\n\n";
+        oss << "\t" << bucket.model << "(const std::string id, const " << state_name << "& initial): Atomic<" << state_name << ">(id, initial) {\n";
+        oss << "\t\tdevsmap_add_ports();\n";
+        oss << "\t}\n";
+        oss << "\t" << bucket.model << "(const std::string id): Atomic<" << state_name << ">(id, devsmap_initial()) {\n";
+        oss << "\t\tdevsmap_add_ports();\n";
+        oss << "\t}\n\n";
+
+        oss << "\tvoid internalTransition(" << state_name << "& state) const override {\n";
+        for(auto& model : models) {
+            oss << "\t\tfor(size_t devsmap_i = 0; devsmap_i < state." << model << ".size(); devsmap_i++) {\n";
+            oss << atomics.at(model)->fused_ladder("delta_int", "state." + model + "[devsmap_i]", "devsmap_" + model + "[devsmap_i]", "\t\t\t");
+            oss << "\t\t}\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\t// members have no input coupled\n";
+        oss << "\tvoid externalTransition(" << state_name << "& state, double e) const override {}\n\n";
+
+        oss << "\tvoid confluentTransition(" << state_name << "& state, double e) const override {\n";
+        oss << "\t\tinternalTransition(state);\n";
+        oss << "\t}\n\n";
+
+        oss << "\tvoid output(const " << state_name << "& state) const override {\n";
+        for(auto& model : models) {
+            oss << "\t\tfor(size_t devsmap_i = 0; devsmap_i < state." << model << ".size(); devsmap_i++) {\n";
+            oss << atomics.at(model)->fused_ladder("lambda", "state." + model + "[devsmap_i]", "devsmap_" + model + "[devsmap_i]", "\t\t\t");
+            oss << "\t\t}\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\t[[nodiscard]] double timeAdvance(const " << state_name << "& state) const override {\n";
+        oss << "\t\treturn period;\n";
+        oss << "\t}\n";
+        oss << "};\n\n";
+
+        oss << "#endif //__DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
+
+        return oss.str();
+    }
+
+    const fusion_t* fusion_of(const std::string& component) const {
+        for(auto& fusion : fusions) {
+            for(auto& member : fusion.members) {
+                if(member.component_name == component) {
+                    return &fusion;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Groups of atomic components joined by couplings carrying at least options.fuse_threshold messages
+     * 
+     * Traffic is counted from the "port" lines of a log written by a logged
+     * run (see devsmap/log.hpp), by component name and port.
+     */
+    template<typename Atomics>
+    std::vector<std::vector<std::string>> profile_groups(const Atomics& atomics, const std::unordered_set<std::string>& taken) const {
+        std::vector<std::vector<std::string>> groups;
+        std::ifstream file(options.fuse_profile);
+        if(!file) {
+            std::cerr << "NO TRAFFIC PROFILE " << options.fuse_profile << std::endl;
+            return groups;
+        }
+
+        std::unordered_map<std::string, size_t> traffic;
+        std::string line;
+        std::getline(file, line); // header
+        while(std::getline(file, line)) {
+            std::vector<std::string> fields;
+            std::stringstream ss(line);
+            std::string field;
+            while(std::getline(ss, field, ';')) {
+                fields.push_back(field);
+            }
+            if(fields.size() < 4 || fields[2] != "port") {
+                continue;
+            }
+            auto dot = fields[1].rfind('.');
+            traffic[(dot == std::string::npos ? fields[1] : fields[1].substr(dot + 1)) + "." + fields[3]]++;
+        }
+
+        auto fusable = [&](const std::string& name) {
+            auto it = std::find_if(components.begin(), components.end(), [&](auto& c) { return c.component_name == name; });
+            return it != components.end() && atomics.count(it->model_name) && !taken.count(name);
+        };
+
+        // union-find over the hot couplings, groups listed in component order
+        std::unordered_map<std::string, std::string> parent;
+        std::function<std::string(const std::string&)> find = [&](const std::string& c) -> std::string {
+            auto it = parent.find(c);
+            if(it == parent.end() || it->second == c) {
+                return c;
+            }
+            return it->second = find(it->second);
+        };
+        for(auto& coupling : ic) {
+            auto it = traffic.find(coupling.from.component + "." + coupling.from.port);
+            if(it == traffic.end() || it->second < options.fuse_threshold || !fusable(coupling.from.component) || !fusable(coupling.to.component)) {
+                continue;
+            }
+            auto a = find(coupling.from.component);
+            auto b = find(coupling.to.component);
+            parent[a] = a;
+            parent[b] = a;
+        }
+
+        std::unordered_map<std::string, size_t> group_of;
+        for(auto& component : components) {
+            if(!parent.count(component.component_name)) {
+                continue;
+            }
+            auto root = find(component.component_name);
+            if(!group_of.count(root)) {
+                group_of[root] = groups.size();
+                groups.emplace_back();
+            }
+            groups[group_of[root]].push_back(component.component_name);
+        }
+
+        return groups;
+    }
+
+    /**
+     * @brief Why group cannot be fused, empty when it can
+     */
+    template<typename Atomics>
+    std::string fusion_blocker(const std::vector<std::string>& group, const Atomics& atomics) const {
+        if(options.checkpoint) {
+            return "--checkpoint walks every component";
+        }
+        if(options.time_resolution > 0) {
+            return "fused models keep their clocks in double";
+        }
+        if(group.size() < 2) {
+            return "a group needs two components";
+        }
+        for(auto& name : group) {
+            auto it = std::find_if(components.begin(), components.end(), [&](auto& c) { return c.component_name == name; });
+            if(it == components.end()) {
+                return "no component " + name;
+            }
+            if(!atomics.count(it->model_name)) {
+                return name + " is not an atomic model";
+            }
+            if(fusion_of(name) || std::count(group.begin(), group.end(), name) > 1) {
+                return name + " is in more than one group";
+            }
+            if(!atomics.at(it->model_name)->stop_predicates.is_null()) {
+                return name + " has stop predicates";
+            }
+        }
+        return "";
+    }
+
+    /**
+     * @brief The atomic model running the members of fusion
+     * 
+     * It keeps the member states, the time of each member's last transition
+     * and a clock of its own. Its time advance is the earliest member event;
+     * a transition computes the outputs of the imminent members into their
+     * wires, forwards them along the internal couplings together with the
+     * inputs of the fused model, then runs each member's confluent, internal
+     * or external transition as its own simulator would, in component order.
+     * Like a simulator, a member is imminent once the clock is not before
+     * its next event, so one the clock passes by a rounding error still
+     * transitions.
+     * 
+     * @return std::string 
+     */
+    template<typename Atomics>
+    std::string make_fused(const fusion_t& fusion, const Atomics& atomics) const {
+        std::ostringstream oss;
+        std::string state_name = fusion.model + "State";
+        std::string MODEL_NAME = fusion.model;
+        std::transform(MODEL_NAME.begin(), MODEL_NAME.end(), MODEL_NAME.begin(), ::toupper);
+        auto& members = fusion.members;
+        auto wires = [](const component_t& member) { return "devsmap_" + member.component_name; };
+        auto allocation_scope = [&](const std::string& function) {
+            return options.allocations ? "\t\tdevsmap::allocation_scope_t devsmap_allocation_scope(devsmap_allocation_site, *this, devsmap::allocation_site_t::" + function + ");\n" : "";
+        };
+        auto imminent = [&]() {
+            std::string flags;
+            for(size_t i = 0; i < members.size(); i++) {
+                flags += (i ? ", " : "") + std::string("state.devsmap_tl[") + std::to_string(i) + "] + devsmap_ta_" + members[i].component_name + "(state) <= now";
+            }
+            return "\t\tconst bool imminent[] = {" + flags + "};\n";
+        };
+
+        oss << "#ifndef __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n\n";
+        oss << "#include <algorithm>\n#include <iostream>\n#include <limits>\n#include \"cadmium/modeling/devs/atomic.hpp\"\n#include \"devsmap/fusion.hpp\"\n";
+        if(options.allocations) {
+            oss << "#include \"cadmium/modeling/devs/coupled.hpp\"\n#include \"devsmap/allocations.hpp\"\n";
+        }
+        std::vector<std::string> included;
+        for(auto& member : members) {
+            if(std::find(included.begin(), included.end(), member.model_name) == included.end()) {
+                oss << "#include \"" << member.model_name << ".hpp\"\n";
+                included.push_back(member.model_name);
+            }
+        }
+        oss << "\nusing namespace cadmium;\n\n";
+
+        oss << "// fused from " << model_name << ":";
+        for(auto& member : members) {
+            oss << " " << member.component_name << " (" << member.model_name << ")";
+        }
+        oss << "\n";
+        oss << "struct " << state_name << " {\n";
+        for(auto& member : members) {
+            oss << "\t" << member.model_name << "State " << member.component_name << ";\n";
+        }
+        oss << "\tdouble devsmap_now;\n";
+        oss << "\tdouble devsmap_tl[" << members.size() << "];\n";
+        oss << "};\n";
+        oss << "inline std::ostream& operator<<(std::ostream& out, const " << state_name << "& s) {\n";
+        oss << "\tout << \"{\"";
+        for(size_t i = 0; i < members.size(); i++) {
+            oss << (i ? " << \", \"" : "") << " << \"" << members[i].component_name << ":\" << s." << members[i].component_name;
+        }
+        oss << " << \"}\";\n";
+        oss << "\treturn out;\n";
+        oss << "}\n\n";
+
+        oss << "class " << fusion.model << ": public Atomic<" << state_name << ">{\n\n";
+        oss << "\tprivate:\n";
+        for(auto& member : members) {
+            auto& atomic = atomics.at(member.model_name);
+            oss << "\tstruct " << wires(member) << "_t {\n";
+            for(auto& port : atomic->get_input()) {
+                oss << "\t\tdevsmap::wire_t<" << port.datatype << "> " << port.variable << ";\n";
+            }
+            for(auto& port : atomic->get_output()) {
+                oss << "\t\tdevsmap::wire_t<" << port.datatype << "> " << port.variable << ";\n";
+            }
+            oss << "\t};\n";
+            oss << "\tmutable " << wires(member) << "_t " << wires(member) << ";\n\n";
+        }
+        if(options.allocations) {
+            oss << "\tmutable devsmap::allocation_site_t devsmap_allocation_site;\n\n";
+        }
+
+        oss << "\tpublic:\n";
+        for(auto& [_, port] : fusion.inputs) {
+            oss << "\tPort<" << port.datatype << "> " << port.variable << ";\n";
+        }
+        for(auto& [_, port] : fusion.outputs) {
+            oss << "\tPort<" << port.datatype << "> " << port.variable << ";\n";
+        }
+        oss << "\n";
+
+        std::ostringstream add_ports;
+        for(auto& [_, port] : fusion.inputs) {
+            add_ports << "\t\t" << port.variable << " = addInPort<" << port.datatype << ">(\"" << port.variable << "\");\n";
+        }
+        for(auto& [_, port] : fusion.outputs) {
+            add_ports << "\t\t" << port.variable << " = addOutPort<" << port.datatype << ">(\"" << port.variable << "\");\n";
+        }
+        oss << "\t" << fusion.model << "(const std::string id, const " << state_name << "& initial): Atomic<" << state_name << ">(id, initial) {\n";
+        oss << add_ports.str();
+        oss << "\t}\n";
+        oss << "\t" << fusion.model << "(const std::string id): Atomic<" << state_name << ">(id, " << state_name << "{}) {\n";
+        oss << add_ports.str();
+        oss << "\t}\n\n";
+
+        oss << "\tprivate:\n";
+        for(auto& member : members) {
+            oss << "\tdouble devsmap_ta_" << member.component_name << "(const " << state_name << "& state) const {\n";
+            oss << atomics.at(member.model_name)->fused_ladder("ta", "state." + member.component_name, wires(member), "\t\t");
+            oss << "\t}\n\n";
+        }
+
+        oss << "\t//! Time of the earliest member event, on the fused model's clock\n";
+        oss << "\tdouble devsmap_next(const " << state_name << "& state) const {\n";
+        oss << "\t\treturn std::min({";
+        for(size_t i = 0; i < members.size(); i++) {
+            oss << (i ? ", " : "") << "state.devsmap_tl[" << i << "] + devsmap_ta_" << members[i].component_name << "(state)";
+        }
+        oss << "});\n";
+        oss << "\t}\n\n";
+
+        oss << "\t//! Clears every wire, then runs the output functions of the imminent members into them\n";
+        oss << "\tvoid devsmap_outputs(const " << state_name << "& state, const bool (&imminent)[" << members.size() << "]) const {\n";
+        for(auto& member : members) {
+            auto& atomic = atomics.at(member.model_name);
+            for(auto& port : atomic->get_input()) {
+                oss << "\t\t" << wires(member) << "." << port.variable << ".clear();\n";
+            }
+            for(auto& port : atomic->get_output()) {
+                oss << "\t\t" << wires(member) << "." << port.variable << ".clear();\n";
+            }
+        }
+        for(size_t i = 0; i < members.size(); i++) {
+            oss << "\t\tif(imminent[" << i << "]) {\n";
+            oss << atomics.at(members[i].model_name)->fused_ladder("lambda", "state." + members[i].component_name, wires(members[i]), "\t\t\t");
+            oss << "\t\t}\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\tvoid devsmap_step(" << state_name << "& state) const {\n";
+        oss << "\t\tconst double now = state.devsmap_now;\n";
+        oss << imminent();
+        oss << "\t\tdevsmap_outputs(state, imminent);\n";
+        for(auto& coupling : ic) {
+            auto from = std::find_if(members.begin(), members.end(), [&](auto& m) { return m.component_name == coupling.from.component; });
+            auto to = std::find_if(members.begin(), members.end(), [&](auto& m) { return m.component_name == coupling.to.component; });
+            if(from != members.end() && to != members.end()) {
+                oss << "\t\tdevsmap::forward(" << wires(*from) << "." << coupling.from.port << ", " << wires(*to) << "." << coupling.to.port << ");\n";
+            }
+        }
+        for(auto& [member_port, port] : fusion.inputs) {
+            oss << "\t\tdevsmap::forward(" << port.variable << ", devsmap_" << member_port.component << "." << member_port.port << ");\n";
+        }
+        for(size_t i = 0; i < members.size(); i++) {
+            auto& atomic = atomics.at(members[i].model_name);
+            std::string state_obj = "state." + members[i].component_name;
+            std::string inputs;
+            for(auto& port : atomic->get_input()) {
+                inputs += (inputs.empty() ? "!" : " || !") + wires(members[i]) + "." + port.variable + ".bag.empty()";
+            }
+            if(inputs.empty()) {
+                inputs = "false";
+            }
+
+            oss << "\t\t{\n";
+            oss << "\t\t\tconst bool inputs = " << inputs << ";\n";
+            oss << "\t\t\t[[maybe_unused]] const double e = now - state.devsmap_tl[" << i << "];\n";
+            oss << "\t\t\tif(imminent[" << i << "] && inputs) {\n";
+            oss << atomic->fused_ladder("delta_con", state_obj, wires(members[i]), "\t\t\t\t");
+            oss << "\t\t\t} else if(imminent[" << i << "]) {\n";
+            oss << atomic->fused_ladder("delta_int", state_obj, wires(members[i]), "\t\t\t\t");
+            oss << "\t\t\t} else if(inputs) {\n";
+            oss << atomic->fused_ladder("delta_ext", state_obj, wires(members[i]), "\t\t\t\t");
+            oss << "\t\t\t}\n";
+            oss << "\t\t\tif(imminent[" << i << "] || inputs) {\n";
+            oss << "\t\t\t\tstate.devsmap_tl[" << i << "] = now;\n";
+            oss << "\t\t\t}\n";
+            oss << "\t\t}\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\tpublic:\n";
+        oss << "\tvoid internalTransition(" << state_name << "& state) const override {\n";
+        oss << allocation_scope("internal");
+        oss << "\t\tstate.devsmap_now = devsmap_next(state);\n";
+        oss << "\t\tdevsmap_step(state);\n";
+        oss << "\t}\n\n";
+
+        oss << "\tvoid externalTransition(" << state_name << "& state, double e) const override {\n";
+        oss << allocation_scope("external");
+        oss << "\t\tstate.devsmap_now += e;\n";
+        oss << "\t\tdevsmap_step(state);\n";
+        oss << "\t}\n\n";
+
+        oss << "\tvoid confluentTransition(" << state_name << "& state, double e) const override {\n";
+        oss << allocation_scope("confluent");
+        oss << "\t\tstate.devsmap_now = devsmap_next(state);\n";
+        oss << "\t\tdevsmap_step(state);\n";
+        oss << "\t}\n\n";
+
+        oss << "\tvoid output(const " << state_name << "& state) const override {\n";
+        oss << allocation_scope("output");
+        oss << "\t\tconst double now = devsmap_next(state);\n";
+        oss << imminent();
+        oss << "\t\tdevsmap_outputs(state, imminent);\n";
+        for(auto& [member_port, port] : fusion.outputs) {
+            oss << "\t\tdevsmap::forward(devsmap_" << member_port.component << "." << member_port.port << ", " << port.variable << ");\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\t[[nodiscard]] double timeAdvance(const " << state_name << "& state) const override {\n";
+        oss << "\t\treturn devsmap_next(state) - state.devsmap_now;\n";
+        oss << "\t}\n";
+        oss << "};\n\n";
+
+        oss << "#endif //__DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
+
+        return oss.str();
+    }
+
+    /**
+     * @brief Replaces every fused group and bucket by its component, in components, couplings and initial states
+     */
+    void apply_fusions() {
+        for(auto& fusion : fusions) {
+            json init = json::object();
+            for(auto& member : fusion.members) {
+                json member_init = component_init(member);
+                if(member_init.is_object()) {
+                    for(auto& [variable, value] : member_init.items()) {
+                        init[member.component_name + "." + variable] = value;
+                    }
+                }
+            }
+            if(!init.empty()) {
+                initial_state[fusion.component] = init;
+            }
+
+            auto first = std::find_if(components.begin(), components.end(), [&](auto& c) { return fusion_of(c.component_name) == &fusion; });
+            first = components.insert(first, component_t(fusion.model, fusion.component));
+            components.erase(std::remove_if(first + 1, components.end(), [&](auto& c) { return fusion_of(c.component_name) == &fusion; }), components.end());
+        }
+
+        for(auto& bucket : buckets) {
+            auto first = std::find_if(components.begin(), components.end(), [&](auto& c) { return bucket_of(c.component_name) == &bucket; });
+            first = components.insert(first, component_t(bucket.model, bucket.component));
+            components.erase(std::remove_if(first + 1, components.end(), [&](auto& c) { return bucket_of(c.component_name) == &bucket; }), components.end());
+        }
+
+        auto rewrite = [&](const port_t& port) {
+            auto fusion = fusion_of(port.component);
+            auto bucket = bucket_of(port.component);
+            return fusion ? port_t(fusion->component, port.component + "_" + port.port) :
+                   bucket ? port_t(bucket->component, port.component + "_" + port.port) : port;
+        };
+        std::vector<coupling_t> fused_ic;
+        for(auto& coupling : ic) {
+            auto from = fusion_of(coupling.from.component);
+            if(from && from == fusion_of(coupling.to.component)) {
+                continue;
+            }
+            fused_ic.push_back(coupling_t(rewrite(coupling.from), rewrite(coupling.to)));
+        }
+        ic = fused_ic;
+        for(auto& coupling : eic) {
+            coupling.to = rewrite(coupling.to);
+        }
+        for(auto& coupling : eoc) {
+            coupling.from = rewrite(coupling.from);
+        }
+    }
+
     public:
+    /**
+     * @brief Whether make_model has to wait for fuse() and bucket(), which need every atomic model parsed
+     */
+    bool needs_atomics() const {
+        return !fusion_hints.empty() || !options.fuse_profile.empty() || options.buckets;
+    }
+
+    /**
+     * @brief Groups the atomic components with a constant time advance and no input coupled, by period
+     * 
+     * Such components fire at every multiple of their period from the
+     * start, so each group of at least two is generated as one atomic (see
+     * make_bucket()) and the simulator schedules one component per period
+     * instead of all of them. Components that are fused, logged or have
+     * stop predicates keep their own simulators. Call after fuse().
+     * 
+     * @return the name and header of every bucket model
+     */
+    template<typename Atomics>
+    std::vector<std::pair<std::string, std::string>> bucket(const Atomics& atomics) {
+        std::vector<std::pair<std::string, std::string>> headers;
+        if(!options.buckets) {
+            return headers;
+        }
+        if(options.checkpoint || options.time_resolution > 0) {
+            std::cerr << "NOT BUCKETED " << model_name << ": " << (options.checkpoint ? "--checkpoint walks every component" : "buckets keep their clocks in double") << std::endl;
+            return headers;
+        }
+
+        std::unordered_set<std::string> fed;
+        for(auto& coupling : ic) {
+            fed.insert(coupling.to.component);
+        }
+        for(auto& coupling : eic) {
+            fed.insert(coupling.to.component);
+        }
+
+        std::vector<bucket_t> candidates;
+        for(auto& component : components) {
+            auto it = atomics.find(component.model_name);
+            if(it == atomics.end() || fed.count(component.component_name) || fusion_of(component.component_name) || !it->second->log_selection.is_null() || !it->second->stop_predicates.is_null()) {
+                continue;
+            }
+            auto analysis = it->second->analyse_ta();
+            if(analysis.kind != TimeAdvanceKind::CONSTANT || !(analysis.constant > 0)) {
+                continue;
+            }
+            auto same = std::find_if(candidates.begin(), candidates.end(), [&](auto& b) { return b.period == analysis.constant; });
+            if(same == candidates.end()) {
+                candidates.push_back(bucket_t{"", "", analysis.constant, {}});
+                same = candidates.end() - 1;
+            }
+            same->members.push_back(component);
+        }
+
+        for(auto& candidate : candidates) {
+            if(candidate.members.size() < 2) {
+                continue;
+            }
+            candidate.component = "bucket" + std::to_string(buckets.size());
+            candidate.model = model_name + "_" + candidate.component;
+            buckets.push_back(candidate);
+            headers.emplace_back(candidate.model, make_bucket(buckets.back(), atomics));
+        }
+
+        return headers;
+    }
+
+    /**
+     * @brief Picks the groups to fuse, from the "fuse" hints and then the traffic profile
+     * 
+     * make_model() then emits each group as one component; the parsed
+     * components and couplings are left as they are for the other tools.
+     * 
+     * @return the name and header of every fused model
+     */
+    template<typename Atomics>
+    std::vector<std::pair<std::string, std::string>> fuse(const Atomics& atomics) {
+        std::vector<std::pair<std::string, std::string>> headers;
+
+        auto groups = fusion_hints;
+        if(!options.fuse_profile.empty()) {
+            std::unordered_set<std::string> taken;
+            for(auto& group : groups) {
+                taken.insert(group.begin(), group.end());
+            }
+            for(auto& group : profile_groups(atomics, taken)) {
+                groups.push_back(group);
+            }
+        }
+
+        for(auto& group : groups) {
+            auto blocker = fusion_blocker(group, atomics);
+            if(!blocker.empty()) {
+                std::cerr << "NOT FUSED " << model_name << " [";
+                for(size_t i = 0; i < group.size(); i++) {
+                    std::cerr << (i ? ", " : "") << group[i];
+                }
+                std::cerr << "]: " << blocker << std::endl;
+                continue;
+            }
+
+            fusion_t fusion;
+            fusion.component = "fused" + std::to_string(fusions.size());
+            fusion.model = model_name + "_" + fusion.component;
+            for(auto& name : group) {
+                fusion.members.push_back(*std::find_if(components.begin(), components.end(), [&](auto& c) { return c.component_name == name; }));
+            }
+            auto member = [&](const std::string& name) { return std::find(group.begin(), group.end(), name) != group.end(); };
+            auto model_of = [&](const std::string& name) {
+                return atomics.at(std::find_if(fusion.members.begin(), fusion.members.end(), [&](auto& c) { return c.component_name == name; })->model_name);
+            };
+            auto add = [](std::vector<std::pair<port_t, object_t>>& ports, const port_t& port, const std::vector<object_t>& declared) {
+                if(std::find_if(ports.begin(), ports.end(), [&](auto& p) { return p.first.component == port.component && p.first.port == port.port; }) != ports.end()) {
+                    return;
+                }
+                auto it = std::find_if(declared.begin(), declared.end(), [&](auto& d) { return d.variable == port.port; });
+                ports.emplace_back(port, object_t(port.component + "_" + port.port, it == declared.end() ? "double" : it->datatype));
+            };
+            for(auto& coupling : eic) {
+                if(member(coupling.to.component)) {
+                    add(fusion.inputs, coupling.to, model_of(coupling.to.component)->get_input());
+                }
+            }
+            for(auto& coupling : ic) {
+                if(member(coupling.to.component) && !member(coupling.from.component)) {
+                    add(fusion.inputs, coupling.to, model_of(coupling.to.component)->get_input());
+                }
+                if(member(coupling.from.component) && !member(coupling.to.component)) {
+                    add(fusion.outputs, coupling.from, model_of(coupling.from.component)->get_output());
+                }
+            }
+            for(auto& coupling : eoc) {
+                if(member(coupling.from.component)) {
+                    add(fusion.outputs, coupling.from, model_of(coupling.from.component)->get_output());
+                }
+            }
+
+            fusions.push_back(fusion);
+            headers.emplace_back(fusion.model, make_fused(fusion, atomics));
+        }
+
+        return headers;
+    }
+
     CadmiumCoupledParser(std::string fileName, std::vector<object_t> state_set, bool flag = false): CoupledParser(fileName, state_set, flag) {
         std::vector<std::string> result;
         std::stringstream ss(fileName);
@@ -73,11 +807,152 @@ class CadmiumCoupledParser : public CoupledParser {
         return oss.str();
     }
     
+    json component_init(const component_t& component) const {
+        json init;
+        if(initial_state.contains(component.component_name)) {
+            init = initial_state.at(component.component_name);
+        } else if(initial_state.contains(component.model_name)) {
+            init = initial_state.at(component.model_name);
+        }
+        return init;
+    }
+
+    static std::string state_value(const json& value) {
+        return value.is_string() ? value.get<std::string>() : value.dump();
+    }
+
+    /**
+     * @brief Component models in order of first appearance
+     * 
+     * @return std::vector<std::string> 
+     */
+    std::vector<std::string> component_models() const {
+        std::vector<std::string> models;
+        for(auto& component: components) {
+            if(std::find(models.begin(), models.end(), component.model_name) == models.end()) {
+                models.push_back(component.model_name);
+            }
+        }
+        return models;
+    }
+
+    /**
+     * @brief Distinct initial states of the instances of model, and the index of each instance's state
+     * 
+     * @param model 
+     * @param indices one per instance of model, -1 when it has no initial state
+     * @return std::vector<json> 
+     */
+    std::vector<json> distinct_states(const std::string& model, std::vector<int>& indices) const {
+        std::vector<json> states;
+        std::unordered_map<std::string, int> seen;
+        for(auto& component: components) {
+            if(component.model_name != model) {
+                continue;
+            }
+            json init = component_init(component);
+            if(!init.is_object()) {
+                indices.push_back(-1);
+                continue;
+            }
+            auto [it, inserted] = seen.emplace(init.dump(), static_cast<int>(states.size()));
+            if(inserted) {
+                states.push_back(init);
+            }
+            indices.push_back(it->second);
+        }
+        return states;
+    }
+
+    /**
+     * @brief constexpr component and coupling tables for options.tables, see devsmap/tables.hpp
+     * 
+     * @return std::string 
+     */
+    std::string make_tables() {
+        std::ostringstream oss;
+
+        for(auto& model : component_models()) {
+            std::vector<int> indices;
+            distinct_states(model, indices);
+            oss << "\tstatic constexpr devsmap::component_entry_t devsmap_" << model << "_components[] = {\n";
+            size_t i = 0;
+            for(auto& component: components) {
+                if(component.model_name == model) {
+                    oss << "\t\t{\"" << component.component_name << "\", " << indices[i++] << "},\n";
+                }
+            }
+            oss << "\t};\n";
+        }
+
+        if(!ic.empty() || !eic.empty() || !eoc.empty()) {
+            oss << "\tstatic constexpr devsmap::coupling_entry_t devsmap_couplings[] = {\n";
+            for(auto& coupling: ic) {
+                oss << "\t\t{\"" << coupling.from.component << "\", \"" << coupling.from.port << "\", \"" << coupling.to.component << "\", \"" << coupling.to.port << "\"},\n";
+            }
+            for(auto& coupling: eic) {
+                oss << "\t\t{nullptr, \"" << coupling.from.port << "\", \"" << coupling.to.component << "\", \"" << coupling.to.port << "\"},\n";
+            }
+            for(auto& coupling: eoc) {
+                oss << "\t\t{\"" << coupling.from.component << "\", \"" << coupling.from.port << "\", nullptr, \"" << coupling.to.port << "\"},\n";
+            }
+            oss << "\t};\n";
+        }
+
+        return oss.str();
+    }
+
     std::string make_components() {
         std::ostringstream oss;
 
+        if(options.tables) {
+            // one state per distinct initial state, shared by every instance using it
+            for(auto& model : component_models()) {
+                std::vector<int> indices;
+                auto states = distinct_states(model, indices);
+                std::string table = "devsmap_" + model + "_components";
+                std::string array = "devsmap_" + model + "_states";
+
+                if(!states.empty()) {
+                    oss << "\t\t" << model << "State " << array << "[" << states.size() << "]{};\n";
+                    for(size_t i = 0; i < states.size(); i++) {
+                        for(auto& [variable, value] : states[i].items()) {
+                            oss << "\t\t" << array << "[" << i << "]." << variable << " = " << state_value(value) << ";\n";
+                        }
+                    }
+                }
+
+                bool stateless = std::find(indices.begin(), indices.end(), -1) != indices.end();
+                oss << "\t\tfor(auto& entry : " << table << ") {\n";
+                if(states.empty()) {
+                    oss << "\t\t\taddComponent<" << model << ">(entry.id);\n";
+                } else if(stateless) {
+                    oss << "\t\t\tif(entry.state < 0) {\n";
+                    oss << "\t\t\t\taddComponent<" << model << ">(entry.id);\n";
+                    oss << "\t\t\t} else {\n";
+                    oss << "\t\t\t\taddComponent<" << model << ">(entry.id, " << array << "[entry.state]);\n";
+                    oss << "\t\t\t}\n";
+                } else {
+                    oss << "\t\t\taddComponent<" << model << ">(entry.id, " << array << "[entry.state]);\n";
+                }
+                oss << "\t\t}\n";
+            }
+            return oss.str();
+        }
+
         for(auto& component: components) {
-            oss << "\t\tauto " << component.component_name << " = addComponent<" << component.model_name << ">(\"" << component.component_name << "\");\n";
+            json init = component_init(component);
+
+            if(init.is_object()) {
+                std::string state = component.component_name + "_state";
+                oss << "\t\t" << component.model_name << "State " << state << "{};\n";
+                for(auto& [variable, value] : init.items()) {
+                    oss << "\t\t" << state << "." << variable << " = " << state_value(value) << ";\n";
+                }
+                oss << "\t\tauto " << component.component_name << " = addComponent<" << component.model_name << ">(\"" << component.component_name << "\", " << state << ");\n";
+            } else {
+                oss << "\t\tauto " << component.component_name << " = addComponent<" << component.model_name << ">(\"" << component.component_name << "\");\n";
+            }
         }
 
         return oss.str();
@@ -87,31 +962,97 @@ class CadmiumCoupledParser : public CoupledParser {
 
         std::ostringstream oss;
 
+        if(options.tables) {
+            if(!ic.empty() || !eic.empty() || !eoc.empty()) {
+                oss << "\t\tdevsmap::add_couplings(*this, devsmap_couplings);\n";
+            }
+            return oss.str();
+        }
+
+        // bucket ports are looked up by name, a bucket has one per member port
+        auto out_port = [&](const port_t& port) {
+            bool bucket = std::any_of(buckets.begin(), buckets.end(), [&](auto& b) { return b.component == port.component; });
+            return bucket ? port.component + "->getOutPort(\"" + port.port + "\")" : port.component + "->" + port.port;
+        };
         for(auto& coupling: ic) {
-            oss << "\t\taddCoupling(" << coupling.from.component << "->" << coupling.from.port << ", " << coupling.to.component << "->" << coupling.to.port << ");\n";
+            oss << "\t\taddCoupling(" << out_port(coupling.from) << ", " << coupling.to.component << "->" << coupling.to.port << ");\n";
         }
         for(auto& coupling: eic) {
             oss << "\t\taddCoupling(" << coupling.from.port << ", " << coupling.to.component << "->" << coupling.to.port << ");\n";
         }
         for(auto& coupling: eoc) {
-            oss << "\t\taddCoupling(" << coupling.from.component << "->" << coupling.from.port << ", " << coupling.to.port << ");\n";
+            oss << "\t\taddCoupling(" << out_port(coupling.from) << ", " << coupling.to.port << ");\n";
         }
         
         return oss.str();
     }
     
+    /**
+     * @brief Walks the components in declaration order, see devsmap/checkpoint.hpp
+     * 
+     * @return std::string 
+     */
+    std::string make_checkpoint() {
+        std::ostringstream oss;
+
+        if(options.tables) {
+            oss << "\tvoid checkpoint(devsmap::SnapshotWriter& out) const {\n";
+            for(auto& model : component_models()) {
+                oss << "\t\tfor(auto& entry : devsmap_" << model << "_components) {\n";
+                oss << "\t\t\tstd::static_pointer_cast<" << model << ">(getComponent(entry.id))->checkpoint(out);\n";
+                oss << "\t\t}\n";
+            }
+            oss << "\t}\n\n";
+
+            oss << "\tvoid restore(devsmap::SnapshotReader& in, double time) {\n";
+            for(auto& model : component_models()) {
+                oss << "\t\tfor(auto& entry : devsmap_" << model << "_components) {\n";
+                oss << "\t\t\tstd::static_pointer_cast<" << model << ">(getComponent(entry.id))->restore(in, time);\n";
+                oss << "\t\t}\n";
+            }
+            oss << "\t}\n";
+
+            return oss.str();
+        }
+
+        oss << "\tvoid checkpoint(devsmap::SnapshotWriter& out) const {\n";
+        for(auto& component: components) {
+            oss << "\t\tstd::static_pointer_cast<" << component.model_name << ">(getComponent(\"" << component.component_name << "\"))->checkpoint(out);\n";
+        }
+        oss << "\t}\n\n";
+
+        oss << "\tvoid restore(devsmap::SnapshotReader& in, double time) {\n";
+        for(auto& component: components) {
+            oss << "\t\tstd::static_pointer_cast<" << component.model_name << ">(getComponent(\"" << component.component_name << "\"))->restore(in, time);\n";
+        }
+        oss << "\t}\n";
+
+        return oss.str();
+    }
+
     std::string make_model() {
+        profile_scope_t profile("emit");
         std::ostringstream oss;
 
+        // fused groups are emitted as one component each, the parsed model stays as it is
+        auto parsed = std::make_tuple(components, ic, eic, eoc, initial_state);
+        apply_fusions();
+
         std::string MODEL_NAME = model_name;
         std::transform(MODEL_NAME.begin(), MODEL_NAME.end(), MODEL_NAME.begin(), ::toupper);
 
         oss << "#ifndef __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
         oss << "#define __DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n\n";
         oss << "#include <iostream>\n#include \"cadmium/modeling/devs/coupled.hpp\"\n";
+        if(options.checkpoint) {
+            oss << "#include \"devsmap/checkpoint.hpp\"\n";
+        }
+        if(options.tables) {
+            oss << "#include \"devsmap/tables.hpp\"\n";
+        }
         
-        for(auto component: components) {
-            oss << "#include \"" << component.model_name + ".hpp\"\n";
+        for(auto& model : component_models()) {
+            oss << "#include \"" << model << ".hpp\"\n";
         }
 
         oss << std::endl;
@@ -119,6 +1060,10 @@ class CadmiumCoupledParser : public CoupledParser {
         oss << "using namespace cadmium;\n\n";
 
         oss << "struct " << model_name << ": public Coupled {\n\n";
+
+        if(options.tables) {
+            oss << make_tables() << std::endl;
+        }
         
         oss << make_ports() << std::endl;
 
@@ -126,8 +1071,15 @@ class CadmiumCoupledParser : public CoupledParser {
 
         oss << make_couplings() << std::endl;
 
-        oss << "\t}\n};\n#endif //__DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
+        oss << "\t}\n";
+
+        if(options.checkpoint) {
+            oss << "\n" << make_checkpoint();
+        }
+
+        oss << "};\n#endif //__DEVSMAP__PARSER__" << MODEL_NAME << "__HPP__\n";
 
+        std::tie(components, ic, eic, eoc, initial_state) = parsed;
         return oss.str();
     }
     
@@ -27,6 +27,7 @@
 #include <vector>
 #include <nlohmann/json.hpp>
 #include "datatypes.hpp"
+#include "Profiler.hpp"
 
 using json = nlohmann::json;
 
@@ -114,7 +115,17 @@ class CoupledParser {
         for(auto& [key, value] : model.items()) {
             if(key == "components") {
                 for(auto& [mn, cn] : value.items()) {
-                    components.push_back(component_t(mn, cn));
+                    if(cn.is_array()) { // several instances of one model
+                        for(auto& instance : cn) {
+                            components.push_back(component_t(mn, instance));
+                        }
+                    } else {
+                        components.push_back(component_t(mn, cn));
+                    }
+                }
+            } else if(key == "fuse") {
+                for(auto& group : value) {
+                    fusion_hints.push_back(group.get<std::vector<std::string>>());
                 }
             }
         }
@@ -179,19 +190,33 @@ class CoupledParser {
     
     public:
     std::string model_name;
+    std::string file_name;
+    codegen_options_t options;
+
+    //! initial states of this model's components, keyed by instance or model name
+    json initial_state;
 
-    CoupledParser(std::string fileName, std::vector<object_t> state_set, bool verbose = false) {
-        std::ifstream coupledFile(fileName);
-        DEVSMap = json::parse(coupledFile);
-        coupledFile.close();
+    //! groups of atomic components to generate as one model, from "fuse": [["a", "b"], ...]
+    std::vector<std::vector<std::string>> fusion_hints;
 
-        parse_top_level();
+    CoupledParser(std::string fileName, std::vector<object_t> state_set, bool verbose = false): file_name(fileName) {
+        {
+            profile_scope_t profile("json_parse");
+            std::ifstream coupledFile(fileName);
+            DEVSMap = json::parse(coupledFile);
+            coupledFile.close();
+        }
+
+        {
+            profile_scope_t profile("build_ir");
+            parse_top_level();
 
-        model = DEVSMap.at(model_name);
+            model = DEVSMap.at(model_name);
 
-        parse_xy();
-        parse_components();
-        parse_couplings();
+            parse_xy();
+            parse_components();
+            parse_couplings();
+        }
 
         if (verbose) {
             std::cout << "model name: " << model_name << "\n";
@@ -214,6 +239,13 @@ class CoupledParser {
 
     }
 
+    const std::vector<object_t>& get_input() const { return input; }
+    const std::vector<object_t>& get_output() const { return output; }
+    const std::vector<component_t>& get_components() const { return components; }
+    const std::vector<coupling_t>& get_eic() const { return eic; }
+    const std::vector<coupling_t>& get_eoc() const { return eoc; }
+    const std::vector<coupling_t>& get_ic() const { return ic; }
+
     virtual std::string make_model() = 0;
 };
 
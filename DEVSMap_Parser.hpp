@@ -4,12 +4,22 @@
 #include "AtomicParser.hpp"
 #include "CoupledParser.hpp"
 #include <filesystem>
+#include <limits>
 
 template<typename AMP = AtomicParser, typename CMP = CoupledParser>
 class Parser {
     private:
     json model_under_test;
     json experimental_frame;
+    json output_couplings;
+    double span = std::numeric_limits<double>::infinity();
+    std::string top_model;
+    std::unordered_map<std::string, std::shared_ptr<AMP>> atomics;
+    std::unordered_map<std::string, std::shared_ptr<CMP>> coupleds;
+    std::vector<std::string> pruned;
+    size_t pruned_count = 0;
+    std::string experiment;
+    codegen_options_t options;
 
     // Returns:
     //   true upon success.
@@ -100,57 +110,272 @@ class Parser {
         return directory;
     }
 
-    public:
-    Parser(std::string experiment_file, std::string output_directory) {
+    /**
+     * Removes from every atomic model the ports no coupling of the
+     * experiment uses, see AtomicParser::prune_ports(). Models no coupled
+     * model instantiates are left whole, and ports logged or read by stop
+     * predicates count as used.
+     */
+    void prune_ports() {
+        std::unordered_map<std::string, std::unordered_set<std::string>> consumed, fed;
+        std::unordered_set<std::string> instantiated;
+        for(auto& [_, parser] : coupleds) {
+            std::unordered_map<std::string, std::string> model_of;
+            for(auto& component : parser->get_components()) {
+                model_of[component.component_name] = component.model_name;
+                instantiated.insert(component.model_name);
+            }
+            for(auto& coupling : parser->get_ic()) {
+                consumed[model_of[coupling.from.component]].insert(coupling.from.port);
+                fed[model_of[coupling.to.component]].insert(coupling.to.port);
+            }
+            for(auto& coupling : parser->get_eic()) {
+                fed[model_of[coupling.to.component]].insert(coupling.to.port);
+            }
+            for(auto& coupling : parser->get_eoc()) {
+                consumed[model_of[coupling.from.component]].insert(coupling.from.port);
+            }
+        }
 
-        std::error_code err;
-        if (!CreateDirectoryRecursive(output_directory + "/include", err)) {
-            std::cerr << "CreateDirectoryRecursive FAILED, err: " << err.message() << std::endl;
+        // stable report across runs, whatever the directory order
+        std::vector<std::string> names;
+        for(auto& [name, _] : atomics) {
+            names.push_back(name);
         }
-        
+        std::sort(names.begin(), names.end());
+
+        for(auto& name : names) {
+            if(!instantiated.count(name)) {
+                continue;
+            }
+            auto& parser = atomics.at(name);
+            if(!parser->log_selection.is_null()) {
+                for(auto& port : parser->log_selection.value("ports", json::array())) {
+                    consumed[name].insert(port.template get<std::string>());
+                }
+            }
+            if(!parser->stop_predicates.is_null()) {
+                for(auto& predicate : parser->stop_predicates) {
+                    parser->ports_read(predicate.template get<std::string>(), fed[name], consumed[name]);
+                }
+            }
+
+            std::unordered_set<std::string> unused_outputs, unfed_inputs;
+            for(auto& port : parser->get_output()) {
+                if(!consumed[name].count(port.variable)) {
+                    unused_outputs.insert(port.variable);
+                }
+            }
+            for(auto& port : parser->get_input()) {
+                if(!fed[name].count(port.variable)) {
+                    unfed_inputs.insert(port.variable);
+                }
+            }
+            // the report also lists unfed inputs that stay, so count the ports themselves
+            size_t ports = parser->get_output().size() + parser->get_input().size();
+            for(auto& line : parser->prune_ports(unused_outputs, unfed_inputs)) {
+                pruned.push_back(line);
+            }
+            pruned_count += ports - parser->get_output().size() - parser->get_input().size();
+        }
+    }
+
+    public:
+    /**
+     * Returns the parsed atomic model called name, or nullptr if there is none
+     */
+    std::shared_ptr<AMP> atomic(const std::string& name) const {
+        auto it = atomics.find(name);
+        return (it == atomics.end()) ? nullptr : it->second;
+    }
+
+    /**
+     * Returns the parsed coupled model called name, or nullptr if there is none
+     */
+    std::shared_ptr<CMP> coupled(const std::string& name) const {
+        auto it = coupleds.find(name);
+        return (it == coupleds.end()) ? nullptr : it->second;
+    }
+
+    /**
+     * Name of the model under test
+     */
+    const std::string& top() const {
+        return top_model;
+    }
+
+    /**
+     * Path of the experiment file
+     */
+    const std::string& experiment_file() const {
+        return experiment;
+    }
+
+    /**
+     * The experimental_frame section of the experiment
+     */
+    const json& frame() const {
+        return experimental_frame;
+    }
+
+    /**
+     * Simulated time the experiment asks for (time_span), infinity when it does not say
+     */
+    double time_span() const {
+        return span;
+    }
+
+    /**
+     * Couplings from outputs of the model under test to the acceptor (pocc)
+     */
+    const json& pocc() const {
+        return output_couplings;
+    }
+
+    const std::unordered_map<std::string, std::shared_ptr<AMP>>& atomic_models() const {
+        return atomics;
+    }
+
+    const std::unordered_map<std::string, std::shared_ptr<CMP>>& coupled_models() const {
+        return coupleds;
+    }
+
+    /**
+     * What options.prune removed from the atomic models, one line each
+     */
+    const std::vector<std::string>& pruned_ports() const {
+        return pruned;
+    }
+
+    /**
+     * How many ports options.prune removed from the atomic models
+     */
+    size_t pruned_port_count() const {
+        return pruned_count;
+    }
+
+    /**
+     * Parses the experiment and every model file next to it; nothing is
+     * written until write(), so the models can be validated first
+     */
+    Parser(std::string experiment_file, codegen_options_t _options = codegen_options_t()): experiment(experiment_file), options(_options) {
+
         std::ifstream experimentFile(experiment_file);
         auto DEVSMap = json::parse(experimentFile);
         experimentFile.close();
 
         model_under_test = DEVSMap.at("model_under_test");
         experimental_frame = DEVSMap.at("experimental_frame");
+        output_couplings = DEVSMap.value("pocc", json::array());
+        json time_span = DEVSMap.value("time_span", json());
+        if(time_span.is_number()) {
+            span = time_span.get<double>();
+        } else if(time_span.is_string()) {
+            try {
+                span = std::stod(time_span.get<std::string>());
+            } catch(const std::exception&) {
+                std::cerr << "TIME SPAN " << time_span.dump() << " IS NOT A NUMBER" << std::endl;
+            }
+        }
 
         //std::clog << model_under_test.dump(2) << std::endl << experimental_frame.dump(2) << std::endl;
 
 
 
-        const std::filesystem::path DEVSMap_path{get_path(experiment_file)};
+        std::string DEVSMap_dir = get_path(experiment_file);
+        const std::filesystem::path DEVSMap_path{DEVSMap_dir.empty() ? "./" : DEVSMap_dir};
+        std::string top_file = model_under_test.at("model").get<std::string>();
+
+        json init_states = json::object();
+        if(model_under_test.contains("initial_state") && model_under_test.at("initial_state").is_string()) {
+            std::ifstream initFile(DEVSMap_path / model_under_test.at("initial_state").get<std::string>());
+            if(initFile) {
+                init_states = json::parse(initFile).value("init_states", json::object());
+            }
+        }
 
         if(experimental_frame.empty()) {
             std::cerr << "NO EXPERIMENTAL FRAME IN EXPERIMENT" << std::endl;
         }
+        // mistakes in the log section are the validator's to report
+        json log = experimental_frame.value("log", json::object());
+        json logged_models = log.is_object() ? log.value("models", json::object()) : json::object();
+        json stops = experimental_frame.value("stop", json::object());
 
-        
-    
-        // for(auto const& dir_entry: std::filesystem::directory_iterator{DEVSMap_path}) {
-        //     std::vector<object_t> dummy; //dummy state set
-
-            
-        //     auto file_type = file_type_from_name(dir_entry);
-        //     if(file_type == "atomic") {
-        //         auto parser = AMP(dir_entry.path(), dummy);
-        //         std::string filename = output_directory + "/include/" + parser.model_name + ".hpp";
-        //         std::ofstream file(filename.c_str());
-        //         file << parser.make_model() << std::endl;
-        //         file.close();
-        //     } else if(file_type == "coupled") {
-        //         auto parser = CMP(dir_entry.path(), dummy);
-        //         std::string filename = output_directory + "/include/" + parser.model_name + ".hpp";
-        //         std::ofstream file(filename.c_str());
-        //         file << parser.make_model() << std::endl;
-        //         file.close();
-        //     } else {
-        //         std::cout << dir_entry.path() << " not supported" << std::endl;
-        //     }
-    
-    
-    
-        // }
+        for(auto const& dir_entry: std::filesystem::directory_iterator{DEVSMap_path}) {
+            std::vector<object_t> dummy; //dummy state set
+
+            auto file_type = file_type_from_name(dir_entry);
+            if(file_type == "atomic") {
+                profile_scope_t profile(dir_entry.path().stem().string(), true);
+                auto parser = std::make_shared<AMP>(dir_entry.path(), dummy);
+                profile.rename(parser->model_name); // the emit phases of write() open it by model name
+                parser->options = options;
+                if(logged_models.is_object() && logged_models.contains(parser->model_name) && logged_models.at(parser->model_name).is_object()) {
+                    parser->log_selection = logged_models.at(parser->model_name);
+                    parser->log_selection["every"] = log.contains("every") ? log.at("every") : json(1);
+                    parser->log_selection["interval"] = log.contains("interval") ? log.at("interval") : json(0.0);
+                    if(log.contains("keyframe")) {
+                        parser->log_selection["keyframe"] = log.at("keyframe");
+                    }
+                }
+                if(stops.contains(parser->model_name)) {
+                    auto& predicates = stops.at(parser->model_name);
+                    parser->stop_predicates = predicates.is_string() ? json::array({predicates}) : predicates;
+                }
+                atomics[parser->model_name] = parser;
+            } else if(file_type == "coupled") {
+                profile_scope_t profile(dir_entry.path().stem().string(), true);
+                auto parser = std::make_shared<CMP>(dir_entry.path(), dummy);
+                profile.rename(parser->model_name);
+                parser->options = options;
+                parser->initial_state = init_states.value(parser->model_name, json::object());
+                coupleds[parser->model_name] = parser;
+                if(dir_entry.path().filename() == top_file) {
+                    top_model = parser->model_name;
+                }
+            } else {
+                std::cout << dir_entry.path() << " not supported" << std::endl;
+            }
+        }
+    }
+
+    /**
+     * Writes the header of every model to output_directory/include
+     */
+    void write(const std::string& output_directory) {
+        std::error_code err;
+        if (!CreateDirectoryRecursive(output_directory + "/include", err)) {
+            std::cerr << "CreateDirectoryRecursive FAILED, err: " << err.message() << std::endl;
+        }
+
+        if(options.prune) {
+            prune_ports();
+        }
+
+        for(auto& [name, parser] : atomics) {
+            profile_scope_t profile(name, true);
+            std::string code = parser->make_model();
+
+            profile_scope_t write_profile("write_file");
+            std::ofstream file((output_directory + "/include/" + name + ".hpp").c_str());
+            file << code << std::endl;
+        }
+
+        for(auto& [name, parser] : coupleds) {
+            profile_scope_t profile(name, true);
+            // fused models and buckets need every atomic model parsed
+            auto headers = parser->fuse(atomics);
+            for(auto& header : parser->bucket(atomics)) {
+                headers.push_back(header);
+            }
+            for(auto& [generated_name, code] : headers) {
+                std::ofstream file((output_directory + "/include/" + generated_name + ".hpp").c_str());
+                file << code << std::endl;
+            }
+            std::ofstream file((output_directory + "/include/" + name + ".hpp").c_str());
+            file << parser->make_model() << std::endl;
+        }
     }
 };
 
@@ -0,0 +1,258 @@
+/**
+ * Static memory footprint report for DEVSMap
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Estimates, before anything is compiled, the memory a simulation of the
+ * model under test will hold: the layout of every <model>State as
+ * make_state emits it, the ports and their message types, and for coupled
+ * models the sum over their components multiplied out through the
+ * hierarchy. Cadmium's own per-object costs are not visible from the
+ * DEVSMap files; they come from footprint_costs_t, which holds LP64
+ * libstdc++ figures and is reported next to the results.
+ */
+
+#ifndef FOOTPRINT_HPP
+#define FOOTPRINT_HPP
+
+#include <map>
+#include <set>
+#include "DEVSMap_Parser.hpp"
+
+/////////////////////////////////////FOOTPRINT/////////////////////////////////////
+
+struct footprint_costs_t {
+    size_t component = 96;      //!< vptr, id, parent, in and out port vectors
+    size_t simulator = 48;      //!< Cadmium simulator of one atomic: model pointer, tl, tn, model id
+    size_t coordinator = 72;    //!< Cadmium coordinator of one coupled: model pointer, times, simulators vector
+    size_t port = 120;          //!< member and vector shared_ptrs, control block, port object with its empty bag
+    size_t child = 32;          //!< shared_ptrs to a component and its simulator in the parent
+    size_t coupling = 32;       //!< one entry of a coupling list
+    size_t allocation = 16;     //!< malloc bookkeeping per heap block
+};
+
+template<typename AMP, typename CMP>
+class Footprint {
+    private:
+    struct layout_t {
+        size_t size = 0;
+        size_t align = 1;
+    };
+
+    const Parser<AMP, CMP>& parser;
+    footprint_costs_t costs;
+    std::map<std::string, json> models;
+    std::set<std::string> unknown_types;
+
+    /**
+     * Size and alignment of the state and message types DEVSMap files use;
+     * false for anything else
+     */
+    static bool type_layout(const std::string& datatype, layout_t& layout) {
+        static const std::map<std::string, layout_t> known = {
+            {"bool", {1, 1}}, {"char", {1, 1}}, {"signed char", {1, 1}}, {"unsigned char", {1, 1}},
+            {"int8_t", {1, 1}}, {"uint8_t", {1, 1}},
+            {"short", {2, 2}}, {"unsigned short", {2, 2}}, {"int16_t", {2, 2}}, {"uint16_t", {2, 2}},
+            {"int", {4, 4}}, {"unsigned", {4, 4}}, {"unsigned int", {4, 4}}, {"float", {4, 4}},
+            {"int32_t", {4, 4}}, {"uint32_t", {4, 4}},
+            {"long", {8, 8}}, {"unsigned long", {8, 8}}, {"long long", {8, 8}}, {"unsigned long long", {8, 8}},
+            {"double", {8, 8}}, {"size_t", {8, 8}}, {"int64_t", {8, 8}}, {"uint64_t", {8, 8}},
+            {"long double", {16, 16}},
+            {"std::string", {32, 8}}, {"string", {32, 8}}
+        };
+
+        auto it = known.find(datatype);
+        if(it != known.end()) {
+            layout = it->second;
+            return true;
+        }
+        if(datatype.rfind("std::vector<", 0) == 0) { // the elements live on the heap and are not counted
+            layout = {24, 8};
+            return true;
+        }
+        return false;
+    }
+
+    static size_t align_up(size_t offset, size_t align) {
+        return (offset + align - 1) / align * align;
+    }
+
+    json state_report(const std::vector<object_t>& state_set, layout_t& state) {
+        json fields = json::array();
+        json unknown = json::array();
+        size_t offset = 0;
+        size_t used = 0;
+
+        for(auto& sv : state_set) {
+            layout_t field;
+            if(!type_layout(sv.datatype, field)) {
+                unknown.push_back(sv.datatype);
+                unknown_types.insert(sv.datatype);
+                continue;
+            }
+            offset = align_up(offset, field.align);
+            fields.push_back({{"name", sv.variable}, {"type", sv.datatype}, {"offset", offset}, {"size", field.size}});
+            offset += field.size;
+            used += field.size;
+            state.align = std::max(state.align, field.align);
+        }
+        state.size = std::max<size_t>(align_up(offset, state.align), 1);
+
+        return {{"bytes", state.size}, {"align", state.align}, {"padding", state.size - std::min(used, state.size)}, {"fields", fields}, {"unknown_types", unknown}};
+    }
+
+    json ports_report(const std::vector<object_t>& input, const std::vector<object_t>& output, size_t& bytes) {
+        json messages = json::object();
+        for(auto ports : {&input, &output}) {
+            for(auto& port : *ports) {
+                layout_t message;
+                if(type_layout(port.datatype, message)) {
+                    messages[port.variable] = message.size;
+                } else {
+                    messages[port.variable] = nullptr;
+                    unknown_types.insert(port.datatype);
+                }
+            }
+        }
+        bytes = (input.size() + output.size()) * (costs.port + costs.allocation);
+
+        return {{"in", input.size()}, {"out", output.size()}, {"bytes", bytes}, {"message_bytes", messages}};
+    }
+
+    json& atomic_report(const std::string& name, const AMP& atomic) {
+        auto it = models.find(name);
+        if(it != models.end()) {
+            return it->second;
+        }
+
+        layout_t state;
+        size_t port_bytes;
+        json report;
+        report["kind"] = "atomic";
+        report["state"] = state_report(atomic.get_state_set(), state);
+        report["ports"] = ports_report(atomic.get_input(), atomic.get_output(), port_bytes);
+
+        // model and simulator are one heap block each
+        size_t instance = align_up(costs.component, state.align) + state.size + costs.simulator + 2 * costs.allocation + port_bytes;
+        report["instance_bytes"] = instance;
+        report["total_bytes"] = instance;
+        report["atomic_instances"] = 1;
+
+        return models[name] = report;
+    }
+
+    json& coupled_report(const std::string& name, const CMP& coupled, std::vector<std::string>& stack) {
+        auto it = models.find(name);
+        if(it != models.end()) {
+            return it->second;
+        }
+        if(std::find(stack.begin(), stack.end(), name) != stack.end()) {
+            throw std::runtime_error("COUPLED MODEL " + name + " CONTAINS ITSELF");
+        }
+        stack.push_back(name);
+
+        size_t port_bytes;
+        json report;
+        report["kind"] = "coupled";
+        report["ports"] = ports_report(coupled.get_input(), coupled.get_output(), port_bytes);
+
+        std::map<std::string, size_t> instances;
+        for(auto& component : coupled.get_components()) {
+            instances[component.model_name]++;
+        }
+
+        size_t couplings = coupled.get_ic().size() + coupled.get_eic().size() + coupled.get_eoc().size();
+        size_t own = costs.component + costs.coordinator + 2 * costs.allocation + port_bytes +
+            coupled.get_components().size() * costs.child + couplings * costs.coupling;
+        size_t total = own;
+        size_t atomic_instances = 0;
+        json components = json::object();
+
+        for(auto& [model, count] : instances) {
+            json* child;
+            if(auto atomic = parser.atomic(model)) {
+                child = &atomic_report(model, *atomic);
+            } else if(auto inner = parser.coupled(model)) {
+                child = &coupled_report(model, *inner, stack);
+            } else {
+                throw std::runtime_error("UNKNOWN COMPONENT MODEL " + model + " IN " + name);
+            }
+            size_t child_total = (*child)["total_bytes"];
+            size_t child_atomics = (*child)["atomic_instances"];
+            components[model] = {{"instances", count}, {"bytes", count * child_total}};
+            total += count * child_total;
+            atomic_instances += count * child_atomics;
+        }
+
+        report["components"] = components;
+        report["couplings"] = couplings;
+        report["own_bytes"] = own;
+        report["total_bytes"] = total;
+        report["atomic_instances"] = atomic_instances;
+
+        stack.pop_back();
+        return models[name] = report;
+    }
+
+    public:
+    Footprint(const Parser<AMP, CMP>& _parser, footprint_costs_t _costs = footprint_costs_t()): parser(_parser), costs(_costs) {}
+
+    /**
+     * Every model reachable from the model under test, plus the ones nothing uses
+     */
+    json make_report() {
+        std::vector<std::string> stack;
+        models.clear();
+        unknown_types.clear();
+
+        json report;
+        report["top"] = parser.top();
+        if(auto top = parser.coupled(parser.top())) {
+            auto& top_report = coupled_report(parser.top(), *top, stack);
+            report["total_bytes"] = top_report["total_bytes"];
+            report["atomic_instances"] = top_report["atomic_instances"];
+        } else if(auto atomic = parser.atomic(parser.top())) {
+            auto& top_report = atomic_report(parser.top(), *atomic);
+            report["total_bytes"] = top_report["total_bytes"];
+            report["atomic_instances"] = 1;
+        }
+
+        for(auto& [name, atomic] : parser.atomic_models()) {
+            atomic_report(name, *atomic);
+        }
+        for(auto& [name, coupled] : parser.coupled_models()) {
+            coupled_report(name, *coupled, stack);
+        }
+
+        report["models"] = models;
+        report["unknown_types"] = unknown_types;
+        report["assumptions"] = {
+            {"component", costs.component}, {"simulator", costs.simulator}, {"coordinator", costs.coordinator},
+            {"port", costs.port}, {"child", costs.child}, {"coupling", costs.coupling}, {"allocation", costs.allocation}
+        };
+
+        return report;
+    }
+
+    void write(const std::string& filename) {
+        std::ofstream file(filename);
+        file << make_report().dump(4) << std::endl;
+        file.close();
+    }
+};
+
+#endif //FOOTPRINT_HPP
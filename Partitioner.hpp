@@ -0,0 +1,532 @@
+/**
+ * Coupling graph partitioner for DEVSMap
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Flattens the coupled hierarchy of the model under test down to atomic
+ * instances, splits them across N partitions (balanced on
+ * AtomicParser::estimated_cost, minimizing cut couplings) and emits one
+ * Cadmium coupled model per partition. Cut couplings go through the
+ * devsmap::ProxyOut / devsmap::ProxyIn models of include/devsmap/proxy.hpp.
+ * Every partition also gets a runner, <top>_part<k>_main.cpp, that
+ * simulates it as process k with devsmap::simulate_partition:
+ *
+ *   <top>_part<k> <socket directory> [end time]
+ *
+ * lookahead is baked into the runners, see devsmap::simulate_partition for
+ * what it has to bound.
+ */
+
+#ifndef PARTITIONER_HPP
+#define PARTITIONER_HPP
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <tuple>
+#include "DEVSMap_Parser.hpp"
+
+/////////////////////////////////////PARTITIONER/////////////////////////////////////
+
+template<typename AMP, typename CMP>
+class Partitioner {
+    private:
+    struct vertex_t {
+        std::string path;   //!< dotted instance path, e.g. "sub.counter_model"
+        std::string model;  //!< atomic model name
+        size_t cost;
+        json init;          //!< initial state of the instance, as in its parent coupled model
+        size_t partition = 0;
+    };
+
+    struct edge_t {
+        size_t from;        //!< vertex index, or npos for a top level input
+        std::string port_from;
+        size_t to;          //!< vertex index, or npos for a top level output
+        std::string port_to;
+        std::string datatype;
+    };
+
+    struct channel_t {
+        size_t from;
+        std::string port_from;
+        size_t partition_to;
+        std::string datatype;
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    const Parser<AMP, CMP>& parser;
+    size_t n_partitions;
+    double lookahead;
+    double imbalance;
+
+    std::vector<vertex_t> vertices;
+    std::vector<edge_t> edges;
+    std::unordered_map<std::string, size_t> vertex_index;
+    std::vector<channel_t> channels;
+    std::map<std::tuple<size_t, std::string, size_t>, size_t> channel_ids;
+
+    //! port node -> coupled port nodes it is connected to; a node is "<path:port" for an input, ">path:port" for an output
+    std::unordered_map<std::string, std::vector<std::string>> port_graph;
+
+    static std::string child_path(const std::string& parent, const std::string& child) {
+        return parent.empty() ? child : parent + "." + child;
+    }
+
+    static std::string identifier(std::string path) {
+        std::replace(path.begin(), path.end(), '.', '_');
+        return path;
+    }
+
+    void flatten(const std::string& model_name, const std::string& path) {
+        auto coupled = parser.coupled(model_name);
+
+        for(auto& component : coupled->get_components()) {
+            std::string cpath = child_path(path, component.component_name);
+
+            if(auto atomic = parser.atomic(component.model_name)) {
+                vertex_index[cpath] = vertices.size();
+                vertices.push_back({cpath, component.model_name, atomic->estimated_cost(), coupled->component_init(component)});
+            } else if(parser.coupled(component.model_name)) {
+                flatten(component.model_name, cpath);
+            } else {
+                throw std::runtime_error("UNKNOWN MODEL '" + component.model_name + "' IN " + model_name);
+            }
+        }
+
+        // coupled ports of this level are addressed by the level's own path; an input and an output may share a name
+        auto input = [&](const std::string& component, const std::string& port) {
+            return "<" + child_path(path, component) + ":" + port;
+        };
+        auto output = [&](const std::string& component, const std::string& port) {
+            return ">" + child_path(path, component) + ":" + port;
+        };
+        for(auto& c : coupled->get_ic()) {
+            port_graph[output(c.from.component, c.from.port)].push_back(input(c.to.component, c.to.port));
+        }
+        for(auto& c : coupled->get_eic()) {
+            port_graph["<" + path + ":" + c.from.port].push_back(input(c.to.component, c.to.port));
+        }
+        for(auto& c : coupled->get_eoc()) {
+            port_graph[output(c.from.component, c.from.port)].push_back(">" + path + ":" + c.to.port);
+        }
+    }
+
+    //! Follows coupled ports from start until atomic inputs or top level outputs
+    void resolve(size_t from, const std::string& port_from, const std::string& datatype) {
+        std::string start = (from == npos ? "<" : ">" + vertices[from].path) + ":" + port_from;
+        std::vector<std::string> stack{start};
+
+        while(!stack.empty()) {
+            std::string current = stack.back();
+            stack.pop_back();
+
+            for(auto& next : port_graph[current]) {
+                auto colon = next.rfind(':');
+                bool in = next[0] == '<';
+                std::string path = next.substr(1, colon - 1);
+                std::string port = next.substr(colon + 1);
+
+                if(!in && path.empty()) {
+                    edges.push_back({from, port_from, npos, port, datatype});
+                } else if(in && vertex_index.count(path)) {
+                    edges.push_back({from, port_from, vertex_index[path], port, datatype});
+                } else {
+                    stack.push_back(next);
+                }
+            }
+        }
+    }
+
+    double load(size_t partition) const {
+        double total = 0;
+        for(auto& v : vertices) {
+            if(v.partition == partition) {
+                total += v.cost;
+            }
+        }
+        return total;
+    }
+
+    //! Grows each partition breadth first from its heaviest unassigned vertex
+    void initial_partition(const std::vector<std::vector<std::pair<size_t, size_t>>>& adjacency) {
+        double total = std::accumulate(vertices.begin(), vertices.end(), 0.0, [](double acc, const vertex_t& v) { return acc + v.cost; });
+        std::vector<bool> assigned(vertices.size(), false);
+        size_t remaining = vertices.size();
+
+        std::vector<size_t> by_cost(vertices.size());
+        std::iota(by_cost.begin(), by_cost.end(), 0);
+        std::stable_sort(by_cost.begin(), by_cost.end(), [&](size_t a, size_t b) { return vertices[a].cost > vertices[b].cost; });
+        size_t next_seed = 0;
+
+        for(size_t p = 0; p < n_partitions && remaining > 0; p++) {
+            double target = total / n_partitions;
+            double filled = 0;
+            std::queue<size_t> frontier;
+
+            while(filled < target && remaining > 0) {
+                if(frontier.empty()) {
+                    while(assigned[by_cost[next_seed]]) {
+                        next_seed++;
+                    }
+                    frontier.push(by_cost[next_seed]);
+                }
+
+                size_t v = frontier.front();
+                frontier.pop();
+                if(assigned[v]) {
+                    continue;
+                }
+
+                assigned[v] = true;
+                remaining--;
+                vertices[v].partition = p;
+                filled += vertices[v].cost;
+
+                for(auto& [u, _] : adjacency[v]) {
+                    if(!assigned[u]) {
+                        frontier.push(u);
+                    }
+                }
+            }
+        }
+
+        // leftovers from rounding go to the last partition
+        for(size_t v = 0; v < vertices.size(); v++) {
+            if(!assigned[v]) {
+                vertices[v].partition = n_partitions - 1;
+            }
+        }
+    }
+
+    //! Greedy Fiduccia-Mattheyses style passes: move vertices while the cut shrinks and balance holds
+    void refine(const std::vector<std::vector<std::pair<size_t, size_t>>>& adjacency) {
+        double total = std::accumulate(vertices.begin(), vertices.end(), 0.0, [](double acc, const vertex_t& v) { return acc + v.cost; });
+        double limit = (1.0 + imbalance) * total / n_partitions;
+
+        std::vector<double> loads(n_partitions, 0);
+        for(auto& v : vertices) {
+            loads[v.partition] += v.cost;
+        }
+
+        bool improved = true;
+        for(int pass = 0; improved && pass < 32; pass++) {
+            improved = false;
+
+            for(size_t v = 0; v < vertices.size(); v++) {
+                size_t own = vertices[v].partition;
+                std::vector<long> weight(n_partitions, 0);
+                for(auto& [u, w] : adjacency[v]) {
+                    weight[vertices[u].partition] += w;
+                }
+
+                size_t best = own;
+                long best_gain = 0;
+                for(size_t p = 0; p < n_partitions; p++) {
+                    if(p == own || loads[p] + vertices[v].cost > limit) {
+                        continue;
+                    }
+                    long gain = weight[p] - weight[own];
+                    bool rebalances = gain == 0 && loads[p] + vertices[v].cost < loads[own];
+                    if(gain > best_gain || (best == own && rebalances)) {
+                        best = p;
+                        best_gain = gain;
+                    }
+                }
+
+                if(best != own) {
+                    loads[own] -= vertices[v].cost;
+                    loads[best] += vertices[v].cost;
+                    vertices[v].partition = best;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    void make_channels() {
+        for(auto& e : edges) {
+            if(e.from == npos || e.to == npos || vertices[e.from].partition == vertices[e.to].partition) {
+                continue;
+            }
+            auto key = std::make_tuple(e.from, e.port_from, vertices[e.to].partition);
+            if(!channel_ids.count(key)) {
+                channel_ids[key] = channels.size();
+                channels.push_back({e.from, e.port_from, vertices[e.to].partition, e.datatype});
+            }
+        }
+    }
+
+    size_t channel_of(const edge_t& e) const {
+        return channel_ids.at(std::make_tuple(e.from, e.port_from, vertices[e.to].partition));
+    }
+
+    public:
+    Partitioner(const Parser<AMP, CMP>& _parser, size_t _n_partitions, double _lookahead = 1.0, double _imbalance = 0.1):
+        parser(_parser), n_partitions(std::max<size_t>(1, _n_partitions)), lookahead(_lookahead), imbalance(_imbalance) {
+
+        if(!parser.coupled(parser.top())) {
+            throw std::runtime_error("MODEL UNDER TEST IS NOT A COUPLED MODEL");
+        }
+
+        flatten(parser.top(), "");
+
+        for(size_t v = 0; v < vertices.size(); v++) {
+            for(auto& port : parser.atomic(vertices[v].model)->get_output()) {
+                resolve(v, port.variable, port.datatype);
+            }
+        }
+        for(auto& port : parser.coupled(parser.top())->get_input()) {
+            resolve(npos, port.variable, port.datatype);
+        }
+
+        std::vector<std::vector<std::pair<size_t, size_t>>> adjacency(vertices.size());
+        std::map<std::pair<size_t, size_t>, size_t> weights;
+        for(auto& e : edges) {
+            if(e.from != npos && e.to != npos && e.from != e.to) {
+                weights[std::minmax(e.from, e.to)]++;
+            }
+        }
+        for(auto& [pair, w] : weights) {
+            adjacency[pair.first].emplace_back(pair.second, w);
+            adjacency[pair.second].emplace_back(pair.first, w);
+        }
+
+        initial_partition(adjacency);
+        refine(adjacency);
+        make_channels();
+    }
+
+    size_t cut() const {
+        size_t count = 0;
+        for(auto& e : edges) {
+            if(e.from != npos && e.to != npos && vertices[e.from].partition != vertices[e.to].partition) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    std::string make_partition(size_t partition) {
+        std::ostringstream oss;
+
+        std::string top = parser.top();
+        std::string name = top + "_part" + std::to_string(partition);
+        std::string NAME = name;
+        std::transform(NAME.begin(), NAME.end(), NAME.begin(), ::toupper);
+
+        oss << "#ifndef __DEVSMAP__PARSER__" << NAME << "__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__" << NAME << "__HPP__\n\n";
+        oss << "#include <iostream>\n#include \"cadmium/modeling/devs/coupled.hpp\"\n#include \"devsmap/proxy.hpp\"\n";
+
+        std::set<std::string> models;
+        for(auto& v : vertices) {
+            if(v.partition == partition) {
+                models.insert(v.model);
+            }
+        }
+        for(auto& model : models) {
+            oss << "#include \"" << model << ".hpp\"\n";
+        }
+
+        oss << "\nusing namespace cadmium;\n\n";
+        oss << "struct " << name << ": public Coupled {\n\n";
+
+        // top level ports reaching this partition
+        std::set<std::pair<std::string, std::string>> in_ports, out_ports;
+        for(auto& e : edges) {
+            if(e.from == npos && e.to != npos && vertices[e.to].partition == partition) {
+                in_ports.emplace(e.port_from, e.datatype);
+            }
+            if(e.to == npos && e.from != npos && vertices[e.from].partition == partition) {
+                out_ports.emplace(e.port_to, e.datatype);
+            }
+        }
+
+        for(auto& [port, datatype] : in_ports) {
+            oss << "\tPort<" << datatype << "> " << port << ";\n";
+        }
+        for(auto& [port, datatype] : out_ports) {
+            oss << "\tPort<" << datatype << "> " << port << ";\n";
+        }
+
+        oss << "\t" << name << "(const std::string& id, std::shared_ptr<devsmap::ChannelHub> hub) : Coupled(id) {\n";
+        for(auto& [port, datatype] : in_ports) {
+            oss << "\t\t" << port << " = addInPort<" << datatype << ">(\"" << port << "\");\n";
+        }
+        for(auto& [port, datatype] : out_ports) {
+            oss << "\t\t" << port << " = addOutPort<" << datatype << ">(\"" << port << "\");\n";
+        }
+        oss << "\n";
+
+        for(auto& v : vertices) {
+            if(v.partition != partition) {
+                continue;
+            }
+            if(v.init.is_object()) {
+                std::string state = identifier(v.path) + "_state";
+                oss << "\t\t" << v.model << "State " << state << "{};\n";
+                for(auto& [variable, value] : v.init.items()) {
+                    oss << "\t\t" << state << "." << variable << " = " << CMP::state_value(value) << ";\n";
+                }
+                oss << "\t\tauto " << identifier(v.path) << " = addComponent<" << v.model << ">(\"" << identifier(v.path) << "\", " << state << ");\n";
+            } else {
+                oss << "\t\tauto " << identifier(v.path) << " = addComponent<" << v.model << ">(\"" << identifier(v.path) << "\");\n";
+            }
+        }
+        for(size_t c = 0; c < channels.size(); c++) {
+            if(vertices[channels[c].from].partition == partition) {
+                oss << "\t\tauto proxy_out_" << c << " = addComponent<devsmap::ProxyOut<" << channels[c].datatype << ">>(\"proxy_out_" << c << "\", hub, " << c << ", " << channels[c].partition_to << ");\n";
+                oss << "\t\taddCoupling(" << identifier(vertices[channels[c].from].path) << "->" << channels[c].port_from << ", proxy_out_" << c << "->in);\n";
+            }
+            if(channels[c].partition_to == partition) {
+                oss << "\t\tauto proxy_in_" << c << " = addComponent<devsmap::ProxyIn<" << channels[c].datatype << ">>(\"proxy_in_" << c << "\", hub, " << c << ");\n";
+            }
+        }
+        oss << "\n";
+
+        for(auto& e : edges) {
+            if(e.from == npos && e.to == npos) {
+                // a top level input passed straight through to an output; every partition has both, one carries it
+                if(partition == 0) {
+                    oss << "\t\taddCoupling(" << e.port_from << ", " << e.port_to << ");\n";
+                }
+            } else if(e.from == npos) {
+                if(vertices[e.to].partition == partition) {
+                    oss << "\t\taddCoupling(" << e.port_from << ", " << identifier(vertices[e.to].path) << "->" << e.port_to << ");\n";
+                }
+            } else if(e.to == npos) {
+                if(vertices[e.from].partition == partition) {
+                    oss << "\t\taddCoupling(" << identifier(vertices[e.from].path) << "->" << e.port_from << ", " << e.port_to << ");\n";
+                }
+            } else if(vertices[e.from].partition == partition && vertices[e.to].partition == partition) {
+                oss << "\t\taddCoupling(" << identifier(vertices[e.from].path) << "->" << e.port_from << ", " << identifier(vertices[e.to].path) << "->" << e.port_to << ");\n";
+            } else if(vertices[e.to].partition == partition) {
+                oss << "\t\taddCoupling(proxy_in_" << channel_of(e) << "->out, " << identifier(vertices[e.to].path) << "->" << e.port_to << ");\n";
+            }
+        }
+
+        oss << "\t}\n};\n#endif //__DEVSMAP__PARSER__" << NAME << "__HPP__\n";
+
+        return oss.str();
+    }
+
+    /**
+     * Runner of one partition: binds its socket in the directory given on the
+     * command line and simulates until the end time (default: until every
+     * partition is passive)
+     */
+    std::string make_runner(size_t partition) const {
+        std::ostringstream oss;
+        std::string name = parser.top() + "_part" + std::to_string(partition);
+
+        oss << "#include <iostream>\n#include <limits>\n#include <memory>\n#include <set>\n#include <string>\n";
+        oss << "#include \"cadmium/simulation/root_coordinator.hpp\"\n";
+        oss << "#include \"devsmap/proxy.hpp\"\n";
+        oss << "#include \"" << name << ".hpp\"\n\n";
+
+        oss << "int main(int argc, char** argv) {\n";
+        oss << "\tif(argc < 2) {\n";
+        oss << "\t\tstd::cerr << \"Usage: \" << argv[0] << \" <socket directory> [end time]\" << std::endl;\n";
+        oss << "\t\treturn 1;\n";
+        oss << "\t}\n";
+        oss << "\tdouble end = argc > 2 ? std::stod(argv[2]) : std::numeric_limits<double>::infinity();\n\n";
+
+        oss << "\tauto hub = std::make_shared<devsmap::ChannelHub>(std::make_shared<devsmap::UnixSocketTransport>(argv[1], " << partition << "));\n";
+        oss << "\tauto model = std::make_shared<" << name << ">(\"" << name << "\", hub);\n";
+        oss << "\tauto root = cadmium::RootCoordinator(model);\n";
+        oss << "\troot.start();\n";
+        std::set<std::string> sources;
+        for(auto& c : channels) {
+            if(vertices[c.from].partition == partition) {
+                sources.insert("\"" + identifier(vertices[c.from].path) + "\"");
+            }
+        }
+        oss << "\tstd::set<std::string> sources{";
+        for(auto it = sources.begin(); it != sources.end(); it++) {
+            oss << (it == sources.begin() ? "" : ", ") << *it;
+        }
+        oss << "};\n";
+        oss << "\tdevsmap::simulate_partition(root, *hub, end, " << lookahead << ", sources);\n";
+        oss << "\troot.stop();\n";
+        oss << "\treturn 0;\n";
+        oss << "}\n";
+
+        return oss.str();
+    }
+
+    /**
+     * Summary of the partitioning: members and load of every partition, the
+     * channels with their endpoints, and the cut size
+     */
+    json make_manifest() const {
+        json manifest;
+        manifest["model"] = parser.top();
+        manifest["partitions"] = json::array();
+        manifest["lookahead"] = lookahead;
+        manifest["cut_couplings"] = cut();
+
+        for(size_t p = 0; p < n_partitions; p++) {
+            json partition;
+            partition["header"] = parser.top() + "_part" + std::to_string(p) + ".hpp";
+            partition["runner"] = parser.top() + "_part" + std::to_string(p) + "_main.cpp";
+            partition["load"] = load(p);
+            partition["components"] = json::array();
+            for(auto& v : vertices) {
+                if(v.partition == p) {
+                    partition["components"].push_back(v.path);
+                }
+            }
+            manifest["partitions"].push_back(partition);
+        }
+
+        manifest["channels"] = json::array();
+        for(size_t c = 0; c < channels.size(); c++) {
+            manifest["channels"].push_back({
+                {"id", c},
+                {"from", vertices[channels[c].from].path + "." + channels[c].port_from},
+                {"partition_from", vertices[channels[c].from].partition},
+                {"partition_to", channels[c].partition_to},
+                {"datatype", channels[c].datatype}
+            });
+        }
+
+        return manifest;
+    }
+
+    void write(const std::string& output_directory) {
+        for(size_t p = 0; p < n_partitions; p++) {
+            std::string filename = output_directory + "/include/" + parser.top() + "_part" + std::to_string(p) + ".hpp";
+            std::ofstream file(filename.c_str());
+            file << make_partition(p) << std::endl;
+            file.close();
+
+            std::ofstream runner(output_directory + "/" + parser.top() + "_part" + std::to_string(p) + "_main.cpp");
+            runner << make_runner(p);
+            runner.close();
+        }
+
+        std::ofstream file(output_directory + "/" + parser.top() + "_partitions.json");
+        file << make_manifest().dump(4) << std::endl;
+        file.close();
+    }
+};
+
+#endif //PARTITIONER_HPP
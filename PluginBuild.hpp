@@ -0,0 +1,179 @@
+/**
+ * Shared-object plugin generation for DEVSMap
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Next to the generated headers, writes
+ *  - plugins/<model>.cpp:   the devsmap_plugin() descriptor of every atomic
+ *                           and coupled model, see devsmap/plugin.hpp
+ *  - devsmap_plugins.cmake: one MODULE library per model, built into
+ *                           <model>.so, a devsmap_plugins target building
+ *                           them all and a devsmap_plugin_loader interface
+ *                           library for the simulators loading them
+ * so editing one model rebuilds its own shared object and those of the
+ * coupled models containing it, and never relinks the simulator. A coupled
+ * plugin compiles its whole subtree in; atomic plugins can be coupled by
+ * hand through their ports.
+ */
+
+#ifndef PLUGIN_BUILD_HPP
+#define PLUGIN_BUILD_HPP
+
+#include <algorithm>
+#include <filesystem>
+#include "DEVSMap_Parser.hpp"
+
+/////////////////////////////////////PLUGIN BUILD/////////////////////////////////////
+
+template<typename AMP, typename CMP>
+class PluginBuild {
+    private:
+    const Parser<AMP, CMP>& parser;
+    std::vector<std::string> atomic_names;
+    std::vector<std::string> coupled_names;
+
+    public:
+    PluginBuild(const Parser<AMP, CMP>& _parser): parser(_parser) {
+        for(auto& [name, _] : parser.atomic_models()) {
+            atomic_names.push_back(name);
+        }
+        for(auto& [name, _] : parser.coupled_models()) {
+            coupled_names.push_back(name);
+        }
+        // stable output across runs, whatever the directory order
+        std::sort(atomic_names.begin(), atomic_names.end());
+        std::sort(coupled_names.begin(), coupled_names.end());
+    }
+
+    /**
+     * Atomic plugins take the raw bytes of their state when it is trivially
+     * copyable, and a value-initialized state for an empty blob
+     */
+    std::string make_atomic_plugin(const std::string& name) const {
+        std::ostringstream oss;
+        std::string state_name = name + "State";
+
+        oss << "#include <cstring>\n#include <type_traits>\n";
+        oss << "#include \"" << name << ".hpp\"\n#include \"devsmap/plugin.hpp\"\n\n";
+
+        oss << "namespace {\n\n";
+        oss << "constexpr bool blob_state = std::is_trivially_copyable_v<" << state_name << ">;\n\n";
+        oss << "void* create(const char* id, const void* state, size_t size) {\n";
+        oss << "\t" << state_name << " initial{};\n";
+        oss << "\tif(size != 0) {\n";
+        oss << "\t\tif(!blob_state || size != sizeof(" << state_name << ")) {\n";
+        oss << "\t\t\treturn nullptr;\n";
+        oss << "\t\t}\n";
+        oss << "\t\tstd::memcpy(static_cast<void*>(&initial), state, size);\n";
+        oss << "\t}\n";
+        oss << "\treturn static_cast<cadmium::Component*>(new " << name << "(id, initial));\n";
+        oss << "}\n\n";
+        oss << "void destroy(void* model) {\n";
+        oss << "\tdelete static_cast<" << name << "*>(static_cast<cadmium::Component*>(model));\n";
+        oss << "}\n\n";
+        oss << "const devsmap_plugin_t descriptor = {DEVSMAP_PLUGIN_ABI, \"" << name << "\", \"atomic\", blob_state ? sizeof(" << state_name << ") : 0, create, destroy};\n\n";
+        oss << "} //namespace\n\n";
+
+        oss << "DEVSMAP_PLUGIN_EXPORT const devsmap_plugin_t* devsmap_plugin() {\n";
+        oss << "\treturn &descriptor;\n";
+        oss << "}\n";
+
+        return oss.str();
+    }
+
+    //! Coupled plugins build the initial state they were generated with and take no blob
+    std::string make_coupled_plugin(const std::string& name) const {
+        std::ostringstream oss;
+
+        oss << "#include \"" << name << ".hpp\"\n#include \"devsmap/plugin.hpp\"\n\n";
+
+        oss << "namespace {\n\n";
+        oss << "void* create(const char* id, const void*, size_t size) {\n";
+        oss << "\tif(size != 0) {\n";
+        oss << "\t\treturn nullptr;\n";
+        oss << "\t}\n";
+        oss << "\treturn static_cast<cadmium::Component*>(new " << name << "(id));\n";
+        oss << "}\n\n";
+        oss << "void destroy(void* model) {\n";
+        oss << "\tdelete static_cast<" << name << "*>(static_cast<cadmium::Component*>(model));\n";
+        oss << "}\n\n";
+        oss << "const devsmap_plugin_t descriptor = {DEVSMAP_PLUGIN_ABI, \"" << name << "\", \"coupled\", 0, create, destroy};\n\n";
+        oss << "} //namespace\n\n";
+
+        oss << "DEVSMAP_PLUGIN_EXPORT const devsmap_plugin_t* devsmap_plugin() {\n";
+        oss << "\treturn &descriptor;\n";
+        oss << "}\n";
+
+        return oss.str();
+    }
+
+    std::string make_cmake_fragment() const {
+        std::ostringstream oss;
+        std::string runtime_include = runtime_include_dir();
+
+        oss << "# Generated by the DEVSMap parser: include() this file, build devsmap_plugins\n";
+        oss << "# and link simulators against devsmap_plugin_loader\n";
+        oss << "if(NOT DEFINED DEVSMAP_RUNTIME_INCLUDE)\n";
+        if(runtime_include.empty()) {
+            oss << "    message(FATAL_ERROR \"set DEVSMAP_RUNTIME_INCLUDE to the include directory of the DEVSMap parser\")\n";
+        } else {
+            oss << "    set(DEVSMAP_RUNTIME_INCLUDE \"" << runtime_include << "\")\n";
+        }
+        oss << "endif()\n\n";
+
+        oss << "add_library(devsmap_plugin_loader INTERFACE)\n";
+        oss << "target_include_directories(devsmap_plugin_loader INTERFACE ${DEVSMAP_RUNTIME_INCLUDE} \"$ENV{CADMIUM}\" \"$ENV{CADMIUM}/../json/include\")\n";
+        oss << "target_compile_options(devsmap_plugin_loader INTERFACE -std=gnu++2b)\n";
+        oss << "target_link_libraries(devsmap_plugin_loader INTERFACE ${CMAKE_DL_LIBS})\n\n";
+
+        oss << "add_custom_target(devsmap_plugins)\n";
+        auto add = [&](const std::string& name) {
+            oss << "add_library(" << name << "_plugin MODULE ${CMAKE_CURRENT_LIST_DIR}/plugins/" << name << ".cpp)\n";
+            oss << "set_target_properties(" << name << "_plugin PROPERTIES PREFIX \"\" OUTPUT_NAME " << name << " CXX_VISIBILITY_PRESET hidden LIBRARY_OUTPUT_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}/plugins)\n";
+            oss << "target_include_directories(" << name << "_plugin PRIVATE ${CMAKE_CURRENT_LIST_DIR}/include ${DEVSMAP_RUNTIME_INCLUDE} \"$ENV{CADMIUM}\" \"$ENV{CADMIUM}/../json/include\")\n";
+            oss << "target_compile_options(" << name << "_plugin PRIVATE -std=gnu++2b)\n";
+            oss << "add_dependencies(devsmap_plugins " << name << "_plugin)\n";
+        };
+        for(auto& name : atomic_names) {
+            add(name);
+        }
+        for(auto& name : coupled_names) {
+            add(name);
+        }
+
+        return oss.str();
+    }
+
+    void write(const std::string& output_directory) const {
+        auto write_file = [](const std::string& filename, const std::string& content) {
+            std::ofstream file(filename.c_str());
+            file << content;
+            file.close();
+        };
+
+        std::filesystem::create_directories(output_directory + "/plugins");
+        for(auto& name : atomic_names) {
+            write_file(output_directory + "/plugins/" + name + ".cpp", make_atomic_plugin(name));
+        }
+        for(auto& name : coupled_names) {
+            write_file(output_directory + "/plugins/" + name + ".cpp", make_coupled_plugin(name));
+        }
+        write_file(output_directory + "/devsmap_plugins.cmake", make_cmake_fragment());
+    }
+};
+
+#endif //PLUGIN_BUILD_HPP
@@ -0,0 +1,303 @@
+/**
+ * Code generator profiler for DEVSMap
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Records a call tree of named phases (one root per model) with wall time
+ * and, when a translation unit defines DEVSMAP_COUNT_ALLOCATIONS before
+ * including this header, the number and size of heap allocations, counted
+ * by the allocator of include/devsmap/allocation_hook.hpp. The generator
+ * only does so when configured with -DDEVSMAP_PROFILE_ALLOCATIONS=ON. Phases are
+ * opened with a profile_scope_t; while the profiler is disabled that costs a
+ * single branch. Phases opened outside any model (validation, say) are
+ * roots too, reported with the phases but not as models.
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <nlohmann/json.hpp>
+#include "devsmap/allocation_hook.hpp"
+
+using json = nlohmann::json;
+
+/////////////////////////////////////PROFILER/////////////////////////////////////
+
+class Profiler {
+    private:
+    struct node_t {
+        const char* name;
+        node_t* parent;
+        std::vector<std::unique_ptr<node_t>> children;
+        std::string label;          //!< owned name, used for model roots
+        bool model = false;         //!< opened by enter_model
+        size_t calls = 0;
+        double total_us = 0;        //!< inclusive
+        size_t allocations = 0;     //!< inclusive
+        size_t bytes = 0;           //!< inclusive
+
+        node_t(const char* n, node_t* p): name(n), parent(p) {}
+
+        double self_us() const {
+            double self = total_us;
+            for(auto& child : children) {
+                self -= child->total_us;
+            }
+            return self;
+        }
+    };
+
+    node_t root{"root", nullptr};
+    node_t* current = &root;
+
+    void fold(const node_t& node, const std::string& stack, std::ostream& out) const {
+        std::string path = stack.empty() ? std::string(node.name) : stack + ";" + node.name;
+        auto self = static_cast<long long>(node.self_us());
+        if(self > 0) {
+            out << path << " " << self << "\n";
+        }
+        for(auto& child : node.children) {
+            fold(*child, path, out);
+        }
+    }
+
+    static void aggregate(const node_t& node, std::map<std::string, json>& phases) {
+        for(auto& child : node.children) {
+            auto& phase = phases[child->name];
+            if(phase.is_null()) {
+                phase = {{"self_ms", 0.0}, {"calls", 0}, {"allocations", 0}, {"bytes", 0}};
+            }
+            size_t child_allocations = 0, child_bytes = 0;
+            for(auto& grandchild : child->children) {
+                child_allocations += grandchild->allocations;
+                child_bytes += grandchild->bytes;
+            }
+            phase["self_ms"] = phase["self_ms"].get<double>() + child->self_us() / 1000.0;
+            phase["calls"] = phase["calls"].get<size_t>() + child->calls;
+            phase["allocations"] = phase["allocations"].get<size_t>() + child->allocations - child_allocations;
+            phase["bytes"] = phase["bytes"].get<size_t>() + child->bytes - child_bytes;
+            aggregate(*child, phases);
+        }
+    }
+
+    public:
+    bool enabled = false;
+    bool allocations_tracked = false;
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void enter(const char* name) {
+        for(auto& child : current->children) {
+            if(std::strcmp(child->name, name) == 0) {
+                current = child.get();
+                return;
+            }
+        }
+        current->children.push_back(std::make_unique<node_t>(name, current));
+        current = current->children.back().get();
+    }
+
+    //! Opens a root for one model; the label is copied so callers may pass temporaries
+    void enter_model(const std::string& label) {
+        current = &root;
+        for(auto& child : root.children) {
+            if(child->label == label) {
+                current = child.get();
+                return;
+            }
+        }
+        root.children.push_back(std::make_unique<node_t>(nullptr, &root));
+        root.children.back()->label = label;
+        root.children.back()->model = true;
+        root.children.back()->name = root.children.back()->label.c_str();
+        current = root.children.back().get();
+    }
+
+    //! Renames the open model root, for a model whose name is only known once its file is parsed
+    void rename_model(const std::string& label) {
+        node_t* node = current;
+        while(node != &root && node->parent != &root) {
+            node = node->parent;
+        }
+        if(node != &root && node->model) {
+            node->label = label;
+            node->name = node->label.c_str();
+        }
+    }
+
+    void leave(double us, size_t allocation_count, size_t allocated_bytes) {
+        current->calls++;
+        current->total_us += us;
+        current->allocations += allocation_count;
+        current->bytes += allocated_bytes;
+        current = current->parent;
+    }
+
+    static long peak_rss_kb() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    /**
+     * Models ranked by wall time, each with its per-phase self times and its
+     * slowest phase, plus the same per-phase totals across all models
+     */
+    json make_report() const {
+        json report;
+        report["peak_rss_kb"] = peak_rss_kb();
+        report["allocations_tracked"] = allocations_tracked;
+
+        std::vector<const node_t*> models;
+        double total_us = 0;
+        for(auto& child : root.children) {
+            if(child->model) {
+                models.push_back(child.get());
+            }
+            total_us += child->total_us;
+        }
+        std::sort(models.begin(), models.end(), [](const node_t* a, const node_t* b) { return a->total_us > b->total_us; });
+        report["total_ms"] = total_us / 1000.0;
+
+        report["models"] = json::array();
+        for(auto model : models) {
+            std::map<std::string, json> phases;
+            aggregate(*model, phases);
+
+            std::string slowest;
+            double slowest_ms = -1;
+            for(auto& [name, phase] : phases) {
+                if(phase["self_ms"].get<double>() > slowest_ms) {
+                    slowest_ms = phase["self_ms"].get<double>();
+                    slowest = name;
+                }
+            }
+
+            report["models"].push_back({
+                {"model", model->name},
+                {"total_ms", model->total_us / 1000.0},
+                {"allocations", model->allocations},
+                {"bytes", model->bytes},
+                {"slowest_phase", slowest},
+                {"phases", phases}
+            });
+        }
+
+        std::map<std::string, json> phases;
+        aggregate(root, phases);
+        for(auto model : models) {
+            phases.erase(model->name);
+        }
+        report["phases"] = phases;
+
+        return report;
+    }
+
+    //! Brendan Gregg folded stacks, one line per call path with its self time in microseconds
+    void write(const std::string& report_file, const std::string& folded_file) const {
+        std::ofstream report(report_file);
+        report << make_report().dump(4) << std::endl;
+        report.close();
+
+        std::ofstream folded(folded_file);
+        for(auto& child : root.children) {
+            fold(*child, "", folded);
+        }
+        folded.close();
+    }
+};
+
+/**
+ * Times the enclosing block as a phase of the innermost open phase
+ */
+class profile_scope_t {
+    private:
+    bool active;
+    std::chrono::steady_clock::time_point start;
+    size_t allocations;
+    size_t bytes;
+
+    public:
+    explicit profile_scope_t(const char* name): active(Profiler::instance().enabled) {
+        if(active) {
+            auto& profiler = Profiler::instance();
+            profiler.enter(name);
+            allocations = profiler.allocations;
+            bytes = profiler.bytes;
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    //! Opens a model root instead of a nested phase
+    profile_scope_t(const std::string& model, bool): active(Profiler::instance().enabled) {
+        if(active) {
+            auto& profiler = Profiler::instance();
+            profiler.enter_model(model);
+            allocations = profiler.allocations;
+            bytes = profiler.bytes;
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    //! Renames the model root this scope opened
+    void rename(const std::string& model) {
+        if(active) {
+            Profiler::instance().rename_model(model);
+        }
+    }
+
+    ~profile_scope_t() {
+        if(active) {
+            auto& profiler = Profiler::instance();
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            profiler.leave(us, profiler.allocations - allocations, profiler.bytes - bytes);
+        }
+    }
+};
+
+#ifdef DEVSMAP_COUNT_ALLOCATIONS
+// Counting is a couple of increments and only happens while the profiler is enabled
+struct profile_allocation_hook_t {
+    profile_allocation_hook_t() {
+        Profiler::instance().allocations_tracked = devsmap::observe_allocations([](std::size_t size) {
+            auto& profiler = Profiler::instance();
+            if(profiler.enabled) {
+                profiler.allocations++;
+                profiler.bytes += size;
+            }
+        });
+    }
+} profile_allocation_hook;
+#endif
+
+#endif //PROFILER_HPP
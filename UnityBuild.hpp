@@ -0,0 +1,150 @@
+/**
+ * Unity build and precompiled header output for DEVSMap
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Next to the generated headers, writes
+ *  - include/devsmap_pch.hpp:    the standard and Cadmium headers every model uses
+ *  - include/devsmap_models.hpp: make_<coupled>() factories, the only header
+ *                                simulators need to include
+ *  - devsmap_models.cpp:         the unity translation unit with every model,
+ *                                the explicit instantiations of Atomic<XState>
+ *                                and the factory definitions
+ *  - devsmap_models.cmake:       a devsmap_models static library wiring them
+ *                                together with target_precompile_headers
+ * so all models are parsed and compiled once, whatever includes them.
+ */
+
+#ifndef UNITY_BUILD_HPP
+#define UNITY_BUILD_HPP
+
+#include <algorithm>
+#include "DEVSMap_Parser.hpp"
+
+/////////////////////////////////////UNITY BUILD/////////////////////////////////////
+
+template<typename AMP, typename CMP>
+class UnityBuild {
+    private:
+    const Parser<AMP, CMP>& parser;
+    std::vector<std::string> atomic_names;
+    std::vector<std::string> coupled_names;
+
+    public:
+    UnityBuild(const Parser<AMP, CMP>& _parser): parser(_parser) {
+        for(auto& [name, _] : parser.atomic_models()) {
+            atomic_names.push_back(name);
+        }
+        for(auto& [name, _] : parser.coupled_models()) {
+            coupled_names.push_back(name);
+        }
+        // stable output across runs, whatever the directory order
+        std::sort(atomic_names.begin(), atomic_names.end());
+        std::sort(coupled_names.begin(), coupled_names.end());
+    }
+
+    std::string make_pch() const {
+        std::ostringstream oss;
+
+        oss << "#ifndef __DEVSMAP__PARSER__PCH__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__PCH__HPP__\n\n";
+        oss << "#include <iostream>\n#include <limits>\n#include <memory>\n#include <string>\n";
+        oss << "#include \"cadmium/modeling/devs/atomic.hpp\"\n";
+        oss << "#include \"cadmium/modeling/devs/coupled.hpp\"\n";
+        oss << "#include \"devsmap/traits.hpp\"\n\n";
+        oss << "#endif //__DEVSMAP__PARSER__PCH__HPP__\n";
+
+        return oss.str();
+    }
+
+    std::string make_factories_header() const {
+        std::ostringstream oss;
+
+        oss << "#ifndef __DEVSMAP__PARSER__MODELS__HPP__\n";
+        oss << "#define __DEVSMAP__PARSER__MODELS__HPP__\n\n";
+        oss << "#include <memory>\n#include <string>\n#include \"cadmium/modeling/devs/coupled.hpp\"\n\n";
+        for(auto& name : coupled_names) {
+            oss << "std::shared_ptr<cadmium::Coupled> make_" << name << "(const std::string& id);\n";
+        }
+        oss << "\n#endif //__DEVSMAP__PARSER__MODELS__HPP__\n";
+
+        return oss.str();
+    }
+
+    std::string make_unity() const {
+        std::ostringstream oss;
+
+        oss << "#include \"devsmap_pch.hpp\"\n";
+        oss << "#include \"devsmap_models.hpp\"\n";
+        for(auto& name : atomic_names) {
+            oss << "#include \"" << name << ".hpp\"\n";
+        }
+        for(auto& name : coupled_names) {
+            oss << "#include \"" << name << ".hpp\"\n";
+        }
+        oss << "\n";
+
+        for(auto& name : atomic_names) {
+            oss << "template class cadmium::Atomic<" << name << "State>;\n";
+        }
+        oss << "\n";
+
+        for(auto& name : coupled_names) {
+            oss << "std::shared_ptr<cadmium::Coupled> make_" << name << "(const std::string& id) {\n";
+            oss << "\treturn std::make_shared<" << name << ">(id);\n";
+            oss << "}\n";
+        }
+
+        return oss.str();
+    }
+
+    std::string make_cmake_fragment() const {
+        std::ostringstream oss;
+        std::string runtime_include = runtime_include_dir();
+
+        oss << "# Generated by the DEVSMap parser: include() this file and link devsmap_models\n";
+        oss << "if(NOT DEFINED DEVSMAP_RUNTIME_INCLUDE)\n";
+        if(runtime_include.empty()) {
+            oss << "    message(FATAL_ERROR \"set DEVSMAP_RUNTIME_INCLUDE to the include directory of the DEVSMap parser\")\n";
+        } else {
+            oss << "    set(DEVSMAP_RUNTIME_INCLUDE \"" << runtime_include << "\")\n";
+        }
+        oss << "endif()\n\n";
+        oss << "add_library(devsmap_models STATIC ${CMAKE_CURRENT_LIST_DIR}/devsmap_models.cpp)\n";
+        oss << "target_include_directories(devsmap_models PUBLIC ${CMAKE_CURRENT_LIST_DIR}/include ${DEVSMAP_RUNTIME_INCLUDE} \"$ENV{CADMIUM}\" \"$ENV{CADMIUM}/../json/include\")\n";
+        oss << "target_compile_options(devsmap_models PUBLIC -std=gnu++2b)\n";
+        oss << "target_compile_definitions(devsmap_models PUBLIC DEVSMAP_EXTERN_TEMPLATES)\n";
+        oss << "target_precompile_headers(devsmap_models PRIVATE ${CMAKE_CURRENT_LIST_DIR}/include/devsmap_pch.hpp)\n";
+
+        return oss.str();
+    }
+
+    void write(const std::string& output_directory) const {
+        auto write_file = [](const std::string& filename, const std::string& content) {
+            std::ofstream file(filename.c_str());
+            file << content;
+            file.close();
+        };
+
+        write_file(output_directory + "/include/devsmap_pch.hpp", make_pch());
+        write_file(output_directory + "/include/devsmap_models.hpp", make_factories_header());
+        write_file(output_directory + "/devsmap_models.cpp", make_unity());
+        write_file(output_directory + "/devsmap_models.cmake", make_cmake_fragment());
+    }
+};
+
+#endif //UNITY_BUILD_HPP
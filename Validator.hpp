@@ -0,0 +1,311 @@
+/**
+ * Coupling validation for DEVSMap
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * Checks every EIC, IC and EOC of every coupled model against the ports
+ * of the models involved before any generated header reaches a compiler.
+ * Ports are indexed once per model, so each coupling costs a few hash
+ * lookups; all errors are collected with their file and JSON pointer.
+ * The stop predicates of the experimental frame are checked too: each
+ * must belong to an atomic model and must not read its input ports. So is
+ * the log selection: its models, ports and state variables must exist and
+ * fit the 32 channels of a log mask, and its sampling must be positive.
+ */
+
+#ifndef VALIDATOR_HPP
+#define VALIDATOR_HPP
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include "DEVSMap_Parser.hpp"
+
+/////////////////////////////////////VALIDATOR/////////////////////////////////////
+
+template<typename AMP, typename CMP>
+class Validator {
+    private:
+    struct ports_t {
+        std::unordered_map<std::string, std::string> in;    //!< port -> message type
+        std::unordered_map<std::string, std::string> out;
+    };
+
+    const Parser<AMP, CMP>& parser;
+    std::unordered_map<std::string, ports_t> ports;     //!< model -> its ports
+    std::vector<validation_error_t> errors;
+
+    static ports_t index(const std::vector<object_t>& input, const std::vector<object_t>& output) {
+        ports_t result;
+        result.in.reserve(input.size());
+        result.out.reserve(output.size());
+        for(auto& port : input) {
+            result.in.emplace(port.variable, port.datatype);
+        }
+        for(auto& port : output) {
+            result.out.emplace(port.variable, port.datatype);
+        }
+        return result;
+    }
+
+    /**
+     * Message type of an endpoint's port, nullptr after recording why it does
+     * not resolve. A null component_key stands for the coupled model itself.
+     */
+    const std::string* resolve(const CMP& coupled, const std::unordered_map<std::string_view, const ports_t*>& instances,
+                               const port_t& endpoint, bool in, const char* section, size_t index,
+                               const char* component_key, const char* port_key) {
+        // built only for errors, which keeps valid couplings down to the lookups
+        auto path = [&]() { return "/" + coupled.model_name + "/" + section + "/" + std::to_string(index); };
+
+        const ports_t* owner;
+        std::string owner_name;
+        if(!component_key) {
+            owner = &ports.at(coupled.model_name);
+            owner_name = coupled.model_name;
+        } else {
+            if(endpoint.component.empty()) {
+                errors.emplace_back(coupled.file_name, path(), std::string("MISSING ") + component_key);
+                return nullptr;
+            }
+            auto it = instances.find(endpoint.component);
+            if(it == instances.end()) {
+                errors.emplace_back(coupled.file_name, path() + "/" + component_key, "UNKNOWN COMPONENT " + endpoint.component);
+                return nullptr;
+            }
+            if(!it->second) { // unknown model, already reported at its components entry
+                return nullptr;
+            }
+            owner = it->second;
+            owner_name = endpoint.component;
+        }
+
+        if(endpoint.port.empty()) {
+            errors.emplace_back(coupled.file_name, path(), std::string("MISSING ") + port_key);
+            return nullptr;
+        }
+
+        auto& table = in ? owner->in : owner->out;
+        auto it = table.find(endpoint.port);
+        if(it == table.end()) {
+            errors.emplace_back(coupled.file_name, path() + "/" + port_key, std::string(in ? "NO INPUT PORT " : "NO OUTPUT PORT ") + endpoint.port + " IN " + owner_name);
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    void check_type(const CMP& coupled, const std::string* from, const std::string* to, const char* section, size_t index) {
+        if(from && to && *from != *to) {
+            errors.emplace_back(coupled.file_name, "/" + coupled.model_name + "/" + section + "/" + std::to_string(index), "TYPE MISMATCH " + *from + " --> " + *to);
+        }
+    }
+
+    void validate(const CMP& coupled) {
+        std::string root = "/" + coupled.model_name;
+        std::unordered_map<std::string_view, const ports_t*> instances;     //!< views into the parser's components
+        instances.reserve(coupled.get_components().size());
+
+        for(auto& component : coupled.get_components()) {
+            auto model = ports.find(component.model_name);
+            if(model == ports.end()) {
+                errors.emplace_back(coupled.file_name, root + "/components/" + component.model_name, "UNKNOWN MODEL " + component.model_name);
+            }
+            auto [it, inserted] = instances.emplace(component.component_name, model == ports.end() ? nullptr : &model->second);
+            if(!inserted) {
+                errors.emplace_back(coupled.file_name, root + "/components/" + component.model_name, "DUPLICATE COMPONENT " + component.component_name);
+            }
+        }
+
+        for(size_t i = 0; i < coupled.get_ic().size(); i++) {
+            const char* section = "ic";
+            auto& coupling = coupled.get_ic()[i];
+            auto from = resolve(coupled, instances, coupling.from, false, section, i, "component_from", "port_from");
+            auto to = resolve(coupled, instances, coupling.to, true, section, i, "component_to", "port_to");
+            check_type(coupled, from, to, section, i);
+        }
+        for(size_t i = 0; i < coupled.get_eic().size(); i++) {
+            const char* section = "eic";
+            auto& coupling = coupled.get_eic()[i];
+            auto from = resolve(coupled, instances, coupling.from, true, section, i, nullptr, "port_from");
+            auto to = resolve(coupled, instances, coupling.to, true, section, i, "component_to", "port_to");
+            check_type(coupled, from, to, section, i);
+        }
+        for(size_t i = 0; i < coupled.get_eoc().size(); i++) {
+            const char* section = "eoc";
+            auto& coupling = coupled.get_eoc()[i];
+            auto from = resolve(coupled, instances, coupling.from, false, section, i, "component_from", "port_from");
+            auto to = resolve(coupled, instances, coupling.to, false, section, i, nullptr, "port_to");
+            check_type(coupled, from, to, section, i);
+        }
+    }
+
+    void validate_stops() {
+        auto& file = parser.experiment_file();
+        std::string root = "/experimental_frame/stop";
+        auto stops = parser.frame().value("stop", json::object());
+        if(!stops.is_object()) {
+            errors.emplace_back(file, root, "STOP PREDICATES MUST BE AN OBJECT KEYED BY ATOMIC MODEL");
+            return;
+        }
+
+        for(auto& [model, predicates] : stops.items()) {
+            auto atomic = parser.atomic(model);
+            if(!atomic) {
+                errors.emplace_back(file, root + "/" + model, "NO ATOMIC MODEL " + model + " FOR STOP PREDICATES");
+                continue;
+            }
+            if(!predicates.is_string() && !predicates.is_array()) {
+                errors.emplace_back(file, root + "/" + model, "STOP PREDICATES MUST BE A STRING OR A LIST OF STRINGS");
+                continue;
+            }
+            json list = predicates.is_string() ? json::array({predicates}) : predicates;
+            for(size_t i = 0; i < list.size(); i++) {
+                std::string path = root + "/" + model + (predicates.is_string() ? "" : "/" + std::to_string(i));
+                if(!list[i].is_string()) {
+                    errors.emplace_back(file, path, "STOP PREDICATE MUST BE A STRING");
+                    continue;
+                }
+                std::unordered_set<std::string> inputs, outputs;
+                atomic->ports_read(list[i].template get<std::string>(), inputs, outputs);
+                for(auto& port : inputs) {
+                    errors.emplace_back(file, path, "STOP PREDICATE READS INPUT PORT " + port + " OF " + model);
+                }
+            }
+        }
+    }
+
+    //! Names of a log selection list, recording why it is not a list of strings
+    bool check_names(const std::string& file, const std::string& path, const json& list) {
+        if(!list.is_array()) {
+            errors.emplace_back(file, path, "LOGGED NAMES MUST BE A LIST OF STRINGS");
+            return false;
+        }
+        bool valid = true;
+        for(size_t i = 0; i < list.size(); i++) {
+            if(!list[i].is_string()) {
+                errors.emplace_back(file, path + "/" + std::to_string(i), "LOGGED NAME MUST BE A STRING");
+                valid = false;
+            }
+        }
+        return valid;
+    }
+
+    void validate_logs() {
+        auto& file = parser.experiment_file();
+        std::string root = "/experimental_frame/log";
+        if(!parser.frame().contains("log")) {
+            return;
+        }
+        auto& log = parser.frame().at("log");
+        if(!log.is_object()) {
+            errors.emplace_back(file, root, "LOG SELECTION MUST BE AN OBJECT");
+            return;
+        }
+
+        if(log.contains("every") && (!log.at("every").is_number_integer() || log.at("every").template get<long long>() < 1)) {
+            errors.emplace_back(file, root + "/every", "LOG SAMPLING EVERY MUST BE AN INTEGER OF AT LEAST 1");
+        }
+        if(log.contains("interval") && (!log.at("interval").is_number() || log.at("interval").template get<double>() < 0)) {
+            errors.emplace_back(file, root + "/interval", "LOG SAMPLING INTERVAL MUST BE A NON-NEGATIVE NUMBER");
+        }
+        if(log.contains("keyframe") && !log.at("keyframe").is_number_unsigned()) {
+            errors.emplace_back(file, root + "/keyframe", "LOG KEYFRAME MUST BE A NON-NEGATIVE INTEGER");
+        }
+
+        auto models = log.value("models", json::object());
+        if(!models.is_object()) {
+            errors.emplace_back(file, root + "/models", "LOGGED MODELS MUST BE AN OBJECT KEYED BY ATOMIC MODEL");
+            return;
+        }
+        for(auto& [model, selection] : models.items()) {
+            std::string path = root + "/models/" + model;
+            auto atomic = parser.atomic(model);
+            if(!atomic) {
+                errors.emplace_back(file, path, "NO ATOMIC MODEL " + model + " TO LOG");
+                continue;
+            }
+            if(!selection.is_object()) {
+                errors.emplace_back(file, path, "LOG SELECTION OF " + model + " MUST BE AN OBJECT");
+                continue;
+            }
+
+            size_t count = 0;
+            auto ports = selection.value("ports", json::array());
+            if(check_names(file, path + "/ports", ports)) {
+                auto& output = atomic->get_output();
+                for(size_t i = 0; i < ports.size(); i++) {
+                    auto name = ports[i].template get<std::string>();
+                    if(std::none_of(output.begin(), output.end(), [&](auto& p) { return p.variable == name; })) {
+                        errors.emplace_back(file, path + "/ports/" + std::to_string(i), "NO OUTPUT PORT " + name + " IN " + model + " TO LOG");
+                    }
+                }
+                count += ports.size();
+            }
+            auto state = selection.value("state", json::array());
+            if(check_names(file, path + "/state", state)) {
+                auto& state_set = atomic->get_state_set();
+                for(size_t i = 0; i < state.size(); i++) {
+                    auto name = state[i].template get<std::string>();
+                    if(std::none_of(state_set.begin(), state_set.end(), [&](auto& sv) { return sv.variable == name; })) {
+                        errors.emplace_back(file, path + "/state/" + std::to_string(i), "NO STATE VARIABLE " + name + " IN " + model + " TO LOG");
+                    }
+                }
+                count += state.size();
+            }
+            if(count == 0) {
+                errors.emplace_back(file, path, "NOTHING TO LOG IN " + model);
+            } else if(count > 32) {
+                errors.emplace_back(file, path, "TOO MANY CHANNELS TO LOG IN " + model + ": " + std::to_string(count) + " OVER 32");
+            }
+            if(selection.contains("components")) {
+                check_names(file, path + "/components", selection.at("components"));
+            }
+        }
+    }
+
+    public:
+    Validator(const Parser<AMP, CMP>& _parser): parser(_parser) {}
+
+    /**
+     * Validates every coupled model of the parser, the stop predicates and the log selection
+     *
+     * @return every error found, empty when all couplings, predicates and logged channels are valid
+     */
+    const std::vector<validation_error_t>& run() {
+        profile_scope_t profile("validate");
+        ports.clear();
+        errors.clear();
+
+        for(auto& [name, atomic] : parser.atomic_models()) {
+            ports.emplace(name, index(atomic->get_input(), atomic->get_output()));
+        }
+        for(auto& [name, coupled] : parser.coupled_models()) {
+            ports.emplace(name, index(coupled->get_input(), coupled->get_output()));
+        }
+
+        for(auto& [name, coupled] : parser.coupled_models()) {
+            validate(*coupled);
+        }
+        validate_stops();
+        validate_logs();
+
+        return errors;
+    }
+};
+
+#endif //VALIDATOR_HPP
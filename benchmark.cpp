@@ -0,0 +1,73 @@
+#include <iostream>
+#include "CadmiumAtomicParser.hpp"
+#include "CadmiumCoupledParser.hpp"
+#include "Benchmark.hpp"
+
+std::vector<std::string> split(const std::string& list, char delimiter) {
+    std::vector<std::string> result;
+    std::stringstream ss(list);
+    std::string segment;
+    while (std::getline(ss, segment, delimiter)) {
+        result.push_back(segment);
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+
+    if(argc < 3) {
+        std::cerr << "Error: Too few arguments. Typical usage:\n" << argv[0]
+                  << " <Directory with counter_atomic.json and generator_atomic.json> <Work directory>"
+                  << " [--sizes 10,100,1000] [--shapes wide,deep,traffic,population] [--time 1000] [--variant name=\"cxx flags\"]... [--unity name=\"cxx flags\"]... [--population name=\"cxx flags\"]... [--tables name=\"cxx flags\"]... [--plugin name=\"cxx flags\"]..." << std::endl;
+        return 0;
+    }
+
+    double time_span = 1000;
+    std::vector<std::string> shapes, sizes;
+    std::vector<benchmark_variant_t> variants;
+
+    for(int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if(option == "--sizes") {
+            sizes = split(argv[i + 1], ',');
+        } else if(option == "--shapes") {
+            shapes = split(argv[i + 1], ',');
+        } else if(option == "--time") {
+            time_span = std::stod(argv[i + 1]);
+        } else if(option == "--variant" || option == "--unity" || option == "--population" || option == "--tables" || option == "--plugin") {
+            std::string variant = argv[i + 1];
+            auto eq = variant.find('=');
+            codegen_options_t options;
+            options.unity = option == "--unity";
+            options.tables = option == "--tables";
+            variants.push_back({variant.substr(0, eq), eq == std::string::npos ? "" : variant.substr(eq + 1), options, option == "--population", option == "--plugin"});
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    Benchmark<CadmiumAtomicParser, CadmiumCoupledParser> benchmark(argv[1], argv[2], time_span);
+    if(!shapes.empty()) {
+        benchmark.shapes = shapes;
+    }
+    if(!sizes.empty()) {
+        benchmark.sizes.clear();
+        for(auto& size : sizes) {
+            benchmark.sizes.push_back(std::stoul(size));
+        }
+    }
+    if(!variants.empty()) {
+        benchmark.variants = variants;
+    }
+
+    auto results = benchmark.run_all();
+
+    std::ofstream report(std::string(argv[2]) + "/benchmark.json");
+    report << results.dump(4) << std::endl;
+    report.close();
+
+    Benchmark<CadmiumAtomicParser, CadmiumCoupledParser>::print(results, std::cout);
+
+    return 0;
+}
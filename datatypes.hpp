@@ -1,6 +1,7 @@
 #ifndef DATATYPES_CONSTANTS_HPP
 #define DATATYPES_CONSTANTS_HPP
 
+#include <cstdlib>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -120,6 +121,46 @@ std::ostream& operator<<(std::ostream& out, const ta_t& t) {
     return out;
 }
 
+enum class TimeAdvanceKind {
+    CONSTANT,
+    PARAMETER,
+    STATE_DEPENDENT,
+    PASSIVE
+};
+std::ostream& operator<<(std::ostream& out, const TimeAdvanceKind value){
+    std::string kind;
+
+    if(value == TimeAdvanceKind::CONSTANT) {
+        kind = "CONSTANT";
+    } else if(value == TimeAdvanceKind::PARAMETER) {
+        kind = "PARAMETER";
+    } else if(value == TimeAdvanceKind::STATE_DEPENDENT) {
+        kind = "STATE_DEPENDENT";
+    } else if(value == TimeAdvanceKind::PASSIVE) {
+        kind = "PASSIVE";
+    }
+
+    return out << kind;
+}
+
+/**
+ * Result of the static analysis of a model's ta tree. constant is only
+ * meaningful for CONSTANT and PASSIVE; min_lookahead is a lower bound on
+ * every value the time advance can return (0 when unknown).
+ */
+struct ta_analysis_t {
+    TimeAdvanceKind kind;
+    double constant;
+    bool may_passivate;
+    double min_lookahead;
+
+    ta_analysis_t(TimeAdvanceKind k = TimeAdvanceKind::CONSTANT, double c = 0, bool p = false, double l = 0): kind(k), constant(c), may_passivate(p), min_lookahead(l) {}
+};
+std::ostream& operator<<(std::ostream& out, ta_analysis_t a) {
+    out << "{" << a.kind << " constant:" << a.constant << " may_passivate:" << a.may_passivate << " min_lookahead:" << a.min_lookahead << "}";
+    return out;
+}
+
 struct component_t {
     std::string model_name;
     std::string component_name;
@@ -153,4 +194,53 @@ std::ostream& operator<<(std::ostream& out, coupling_t c) {
     return out;
 }
 
+struct validation_error_t {
+    std::string file;
+    std::string path;       //!< JSON pointer into file
+    std::string message;
+
+    validation_error_t(std::string f, std::string p, std::string m): file(f), path(p), message(m) {}
+};
+std::ostream& operator<<(std::ostream& out, const validation_error_t& e) {
+    out << e.file << ": " << e.path << ": " << e.message;
+    return out;
+}
+
+/**
+ * Switches of the code generators, shared by every model of a run
+ */
+struct codegen_options_t {
+    bool unity = false;     //!< generated atomics declare extern templates for a unity build
+    bool checkpoint = false;    //!< generated models can be saved to and restored from a snapshot
+    bool tables = false;        //!< generated coupled models build themselves from constexpr tables
+    bool trace = false;         //!< generated atomics record transitions and outputs as trace events
+    bool allocations = false;   //!< generated atomics charge the heap allocations of their functions to themselves
+    bool tabulate = false;      //!< generated atomics with a small finite state space use constexpr transition tables
+    size_t tabulate_limit = 4096;   //!< most states a tabulated model may have
+    bool reflect = false;       //!< generated atomics publish constexpr layouts of their state and ports
+    size_t state_budget = 0;    //!< when set, generated atomics static_assert their state fits in this many bytes
+    long long time_resolution = 0;  //!< when set, generated atomics count time in ticks of 1/time_resolution units
+    bool buckets = false;       //!< components with the same constant time advance and no input are generated as one atomic
+    bool prune = false;         //!< ports no coupling of the experiment uses are left out of the generated atomics
+    size_t jobs = 1;            //!< threads generating the functions and long branch lists of one atomic
+    std::string fuse_profile;   //!< devsmap log of a previous run, atomics exchanging many messages are fused
+    size_t fuse_threshold = 1000;   //!< messages over one coupling in fuse_profile that make it worth fusing
+};
+
+/**
+ * Directory of the devsmap runtime headers that generated code includes:
+ * $DEVSMAP_INCLUDE, else the absolute path the build defines as
+ * DEVSMAP_RUNTIME_INCLUDE; empty when neither is known
+ */
+inline std::string runtime_include_dir() {
+    if(const char* dir = std::getenv("DEVSMAP_INCLUDE")) {
+        return dir;
+    }
+#ifdef DEVSMAP_RUNTIME_INCLUDE
+    return DEVSMAP_RUNTIME_INCLUDE;
+#else
+    return "";
+#endif
+}
+
 #endif //DATATYPES_CONSTANTS_HPP
\ No newline at end of file
@@ -0,0 +1,160 @@
+/**
+ * Counting global allocator shared by the DEVSMap allocation tools
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * The generator's Profiler (DEVSMAP_COUNT_ALLOCATIONS) and the per-component
+ * accounting of generated models (DEVSMAP_ALLOCATION_HOOK, allocations.hpp)
+ * both count heap allocations through this one replacement of the global
+ * allocator. Each registers an observer with observe_allocations(), which
+ * is called with the requested size of every allocation.
+ *
+ * The replacement covers the whole operator new / delete family: single
+ * and array, nothrow, std::align_val_t and sized forms, so no allocation
+ * escapes the count and every delete matches its new. It is defined by the
+ * one translation unit that defines either macro before including a header
+ * of the tools; both may be defined together.
+ */
+
+#ifndef DEVSMAP_ALLOCATION_HOOK_HPP
+#define DEVSMAP_ALLOCATION_HOOK_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace devsmap {
+
+using allocation_observer_t = void (*)(std::size_t size);
+
+//! Free slots are null; there is one per tool
+inline allocation_observer_t allocation_observers[4] = {};
+
+//! Registers observer once; false when every slot is taken
+inline bool observe_allocations(allocation_observer_t observer) {
+    for(auto& slot : allocation_observers) {
+        if(slot == observer) {
+            return true;
+        }
+        if(!slot) {
+            slot = observer;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace detail {
+    /**
+     * Counts one allocation and performs it like the default operator new,
+     * calling the new handler until it succeeds; null when there is no
+     * handler left to call
+     */
+    inline void* counted_allocate(std::size_t size, std::size_t alignment) {
+        for(auto observer : allocation_observers) {
+            if(observer) {
+                observer(size);
+            }
+        }
+        if(size == 0) {
+            size = 1;
+        }
+        while(true) {
+            void* p = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                : std::malloc(size);
+            if(p) {
+                return p;
+            }
+            auto handler = std::get_new_handler();
+            if(!handler) {
+                return nullptr;
+            }
+            handler();
+        }
+    }
+
+    inline void* counted_new(std::size_t size, std::size_t alignment) {
+        if(void* p = counted_allocate(size, alignment)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+
+    inline void* counted_new_nothrow(std::size_t size, std::size_t alignment) noexcept {
+        try {
+            return counted_allocate(size, alignment);
+        } catch(const std::bad_alloc&) {
+            return nullptr;
+        }
+    }
+
+    /**
+     * Releases memory of counted_allocate: malloc and aligned_alloc are both
+     * undone by free. Never inlined, so that the compiler does not see free
+     * next to a new expression and warn about a mismatch (-Wmismatched-new-delete).
+     */
+    [[gnu::noinline]] inline void counted_release(void* p) noexcept {
+        std::free(p);
+    }
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_ALLOCATION_HOOK_HPP
+
+#if (defined(DEVSMAP_COUNT_ALLOCATIONS) || defined(DEVSMAP_ALLOCATION_HOOK)) && !defined(DEVSMAP_ALLOCATION_HOOK_DEFINED)
+#define DEVSMAP_ALLOCATION_HOOK_DEFINED
+
+void* operator new(std::size_t size) {
+    return devsmap::detail::counted_new(size, 0);
+}
+void* operator new[](std::size_t size) {
+    return devsmap::detail::counted_new(size, 0);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return devsmap::detail::counted_new_nothrow(size, 0);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return devsmap::detail::counted_new_nothrow(size, 0);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return devsmap::detail::counted_new(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return devsmap::detail::counted_new(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return devsmap::detail::counted_new_nothrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return devsmap::detail::counted_new_nothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { devsmap::detail::counted_release(p); }
+void operator delete[](void* p) noexcept { devsmap::detail::counted_release(p); }
+void operator delete(void* p, std::size_t) noexcept { devsmap::detail::counted_release(p); }
+void operator delete[](void* p, std::size_t) noexcept { devsmap::detail::counted_release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { devsmap::detail::counted_release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { devsmap::detail::counted_release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { devsmap::detail::counted_release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { devsmap::detail::counted_release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { devsmap::detail::counted_release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { devsmap::detail::counted_release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { devsmap::detail::counted_release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { devsmap::detail::counted_release(p); }
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * Per-component heap allocation accounting of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Models generated with --allocations open an allocation scope around
+ * every transition and output function. Allocations made by the global
+ * operator new inside a scope, message bags, string state fields and log
+ * lines included, are charged to that component and function; at exit the
+ * sites are written as a report ranked by bytes, to stderr or to the file
+ * named by the DEVSMAP_ALLOCATIONS environment variable.
+ *
+ * Allocations are counted by the allocator of allocation_hook.hpp, every
+ * form of operator new included, defined by the one translation unit that
+ * defines DEVSMAP_ALLOCATION_HOOK before including this header (usually
+ * the simulator's main file); without it every site reports zero. Meant
+ * for diagnostic builds: the hook replaces the allocator of the whole
+ * program.
+ */
+
+#ifndef DEVSMAP_ALLOCATIONS_HPP
+#define DEVSMAP_ALLOCATIONS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+#include "allocation_hook.hpp"
+#include "path.hpp"
+
+namespace devsmap {
+
+struct allocation_entry_t {
+    std::string component;
+    const char* function;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+class Allocations {
+    private:
+    std::mutex mutex;
+    std::deque<allocation_entry_t> entries;   //!< stable addresses for the scopes counting into them
+
+    Allocations() = default;
+
+    ~Allocations() {
+        report();
+    }
+
+    public:
+    bool hooked = false;    //!< set by the counting operator new, see DEVSMAP_ALLOCATION_HOOK
+
+    static Allocations& instance() {
+        static Allocations allocations;
+        return allocations;
+    }
+
+    //! Entry allocations in the current thread are charged to, null outside any scope
+    static allocation_entry_t*& current() {
+        thread_local allocation_entry_t* entry = nullptr;
+        return entry;
+    }
+
+    allocation_entry_t* entry(const std::string& component, const char* function) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_back({component, function});
+        return &entries.back();
+    }
+
+    void report() {
+        std::lock_guard<std::mutex> lock(mutex);
+        const char* path = std::getenv("DEVSMAP_ALLOCATIONS");
+        std::FILE* file = path ? std::fopen(path, "w") : stderr;
+        if(!file) {
+            return;
+        }
+
+        std::vector<const allocation_entry_t*> ranked;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        for(auto& e : entries) {
+            ranked.push_back(&e);
+            allocations += e.allocations;
+            bytes += e.bytes;
+        }
+        std::stable_sort(ranked.begin(), ranked.end(), [](auto a, auto b) {
+            return a->bytes != b->bytes ? a->bytes > b->bytes : a->allocations > b->allocations;
+        });
+
+        std::fprintf(file, "devsmap allocations: %llu allocations, %llu bytes in %zu component functions%s\n",
+            (unsigned long long)allocations, (unsigned long long)bytes, ranked.size(), hooked ? "" : " (no DEVSMAP_ALLOCATION_HOOK, nothing counted)");
+        std::fprintf(file, "%14s %16s %10s  %s\n", "allocations", "bytes", "function", "component");
+        for(auto e : ranked) {
+            std::fprintf(file, "%14llu %16llu %10s  %s\n", (unsigned long long)e->allocations, (unsigned long long)e->bytes, e->function, e->component.c_str());
+        }
+
+        if(file != stderr) {
+            std::fclose(file);
+        }
+    }
+};
+
+/**
+ * Entries of one component, registered on first use (parents are only
+ * known once the model is fully built)
+ */
+struct allocation_site_t {
+    enum function_t { internal, external, confluent, output, functions };
+
+    allocation_entry_t* entries[functions] = {};
+
+    template<typename C>
+    allocation_entry_t* get(const C& component, function_t function) {
+        static constexpr const char* names[functions] = {"internal", "external", "confluent", "output"};
+        if(!entries[function]) {
+            entries[function] = Allocations::instance().entry(component_path(component), names[function]);
+        }
+        return entries[function];
+    }
+};
+
+/**
+ * Charges the allocations of the enclosing block to one function of a component
+ */
+class allocation_scope_t {
+    private:
+    allocation_entry_t* previous;
+
+    public:
+    template<typename C>
+    allocation_scope_t(allocation_site_t& site, const C& component, allocation_site_t::function_t function) {
+        auto entry = site.get(component, function);
+        previous = Allocations::current();
+        Allocations::current() = entry;
+    }
+
+    ~allocation_scope_t() {
+        Allocations::current() = previous;
+    }
+};
+
+} //namespace devsmap
+
+#ifdef DEVSMAP_ALLOCATION_HOOK
+// Outside a scope counting costs one thread-local load
+struct devsmap_allocation_hook_t {
+    devsmap_allocation_hook_t() {
+        devsmap::Allocations::instance().hooked = devsmap::observe_allocations([](std::size_t size) {
+            if(auto entry = devsmap::Allocations::current()) {
+                entry->allocations++;
+                entry->bytes += size;
+            }
+        });
+    }
+} devsmap_allocation_hook;
+#endif
+
+#endif //DEVSMAP_ALLOCATIONS_HPP
@@ -0,0 +1,86 @@
+/**
+ * Bag aggregates of the DEVSMap expression language
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * port.bagSum(), port.bagMin(), port.bagMax(), port.bagAny(cond) and
+ * port.bagCount(cond) compile into these functions over the message
+ * vector of the port; in cond, _ stands for each message, e.g.
+ * "in.bagCount(_ > threshold)". The loops run over the vector's storage
+ * without bounds checks or early exits, so compilers vectorize them for
+ * arithmetic messages (floating-point sums only with reassociation,
+ * e.g. -ffast-math). Min and max of an empty bag throw, like bag(i).
+ */
+
+#ifndef DEVSMAP_BAG_HPP
+#define DEVSMAP_BAG_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace devsmap {
+
+template<typename T>
+T bag_sum(const std::vector<T>& bag) {
+    T sum{};
+    for(const T& message : bag) {
+        sum += message;
+    }
+    return sum;
+}
+
+template<typename T>
+T bag_min(const std::vector<T>& bag) {
+    if(bag.empty()) {
+        throw std::out_of_range("BAG MIN OF AN EMPTY BAG");
+    }
+    T min = bag.front();
+    for(const T& message : bag) {
+        min = message < min ? message : min;
+    }
+    return min;
+}
+
+template<typename T>
+T bag_max(const std::vector<T>& bag) {
+    if(bag.empty()) {
+        throw std::out_of_range("BAG MAX OF AN EMPTY BAG");
+    }
+    T max = bag.front();
+    for(const T& message : bag) {
+        max = max < message ? message : max;
+    }
+    return max;
+}
+
+template<typename T, typename Cond>
+size_t bag_count(const std::vector<T>& bag, Cond cond) {
+    size_t count = 0;
+    for(const T& message : bag) {
+        count += cond(message) ? 1 : 0;
+    }
+    return count;
+}
+
+template<typename T, typename Cond>
+bool bag_any(const std::vector<T>& bag, Cond cond) {
+    return bag_count(bag, cond) != 0;
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_BAG_HPP
@@ -0,0 +1,210 @@
+/**
+ * Checkpoint/restore of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Snapshot file layout (native endianness, meant to be mmapped back):
+ *   char[8]  "DEVSMAP1"
+ *   double   simulation time
+ *   uint64   number of records
+ *   records, in hierarchy order:
+ *     uint32 id length, id bytes
+ *     double time of last transition, double last time advance
+ *     uint64 state length, state bytes (fields in declaration order)
+ */
+
+#ifndef DEVSMAP_CHECKPOINT_HPP
+#define DEVSMAP_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace devsmap {
+
+constexpr char snapshot_magic[8] = {'D', 'E', 'V', 'S', 'M', 'A', 'P', '1'};
+
+class SnapshotWriter {
+    private:
+    std::string buffer;
+    uint64_t records = 0;
+    size_t state_begin = 0;
+
+    public:
+    template<typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "state fields must be trivially copyable or std::string");
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const std::string& value) {
+        write(static_cast<uint64_t>(value.size()));
+        buffer.append(value);
+    }
+
+    //! Starts the record of one atomic model; its state follows until end()
+    void begin(const std::string& id, double last, double sigma) {
+        write(static_cast<uint32_t>(id.size()));
+        buffer.append(id);
+        write(last);
+        write(sigma);
+        write(static_cast<uint64_t>(0));
+        state_begin = buffer.size();
+        records++;
+    }
+
+    void end() {
+        uint64_t length = buffer.size() - state_begin;
+        std::memcpy(buffer.data() + state_begin - sizeof(uint64_t), &length, sizeof(uint64_t));
+    }
+
+    void save(const std::string& path, double time) const {
+        std::ofstream file(path, std::ios::binary);
+        file.write(snapshot_magic, sizeof(snapshot_magic));
+        file.write(reinterpret_cast<const char*>(&time), sizeof(double));
+        file.write(reinterpret_cast<const char*>(&records), sizeof(uint64_t));
+        file.write(buffer.data(), buffer.size());
+        if(!file) {
+            throw std::runtime_error("CANNOT WRITE SNAPSHOT " + path);
+        }
+    }
+};
+
+class SnapshotReader {
+    private:
+    const char* data = nullptr;
+    size_t size = 0;
+    const char* cursor = nullptr;
+    const char* state_end = nullptr;
+
+    void need(size_t bytes) const {
+        if(cursor + bytes > data + size) {
+            throw std::runtime_error("TRUNCATED SNAPSHOT");
+        }
+    }
+
+    public:
+    explicit SnapshotReader(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat info{};
+        if(fd < 0 || fstat(fd, &info) < 0) {
+            throw std::runtime_error("CANNOT OPEN SNAPSHOT " + path);
+        }
+        size = info.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(mapped == MAP_FAILED) {
+            throw std::runtime_error("CANNOT MAP SNAPSHOT " + path);
+        }
+        data = static_cast<const char*>(mapped);
+        cursor = data;
+
+        need(sizeof(snapshot_magic));
+        if(std::memcmp(data, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+            throw std::runtime_error("NOT A DEVSMAP SNAPSHOT " + path);
+        }
+        cursor += sizeof(snapshot_magic);
+    }
+
+    ~SnapshotReader() {
+        munmap(const_cast<char*>(data), size);
+    }
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    template<typename T>
+    void read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "state fields must be trivially copyable or std::string");
+        need(sizeof(T));
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+    }
+
+    void read(std::string& value) {
+        uint64_t length;
+        read(length);
+        need(length);
+        value.assign(cursor, length);
+        cursor += length;
+    }
+
+    //! Header time; call once, before any record
+    double time() {
+        double t;
+        uint64_t records;
+        read(t);
+        read(records);
+        return t;
+    }
+
+    //! Opens the record of one atomic model, which must be the next one in the file
+    void begin(const std::string& id, double& last, double& sigma) {
+        uint32_t length;
+        read(length);
+        need(length);
+        if(std::string(cursor, length) != id) {
+            throw std::runtime_error("SNAPSHOT RECORD " + std::string(cursor, length) + " WHERE " + id + " WAS EXPECTED");
+        }
+        cursor += length;
+        read(last);
+        read(sigma);
+        uint64_t state_length;
+        read(state_length);
+        need(state_length);
+        state_end = cursor + state_length;
+    }
+
+    void end() {
+        if(cursor != state_end) {
+            throw std::runtime_error("SNAPSHOT STATE LAYOUT MISMATCH");
+        }
+    }
+};
+
+/**
+ * Writes the states of every component of model, with their pending event
+ * times, as a snapshot taken at simulation time
+ */
+template<typename M>
+void save_checkpoint(const M& model, double time, const std::string& path) {
+    SnapshotWriter out;
+    model.checkpoint(out);
+    out.save(path, time);
+}
+
+/**
+ * Restores the states written by save_checkpoint into a freshly built model.
+ * The simulation resumes by starting a root coordinator at the returned time.
+ */
+template<typename M>
+double load_checkpoint(M& model, const std::string& path) {
+    SnapshotReader in(path);
+    double time = in.time();
+    model.restore(in, time);
+    return time;
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_CHECKPOINT_HPP
@@ -0,0 +1,70 @@
+/**
+ * Wires between the components of fused DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * A fused model runs a group of atomic components as one atomic: their
+ * ports become wires, plain message vectors the inlined functions read and
+ * write with the port syntax they were generated with, and the internal
+ * couplings become copies between wires emitted in coupling order. Wires
+ * keep their capacity, so after the first events a message between fused
+ * components costs a push_back.
+ */
+
+#ifndef DEVSMAP_FUSION_HPP
+#define DEVSMAP_FUSION_HPP
+
+#include <vector>
+
+namespace devsmap {
+
+template<typename T>
+struct wire_t {
+    std::vector<T> bag;
+
+    // ports are used through pointers in generated code
+    wire_t* operator->() {
+        return this;
+    }
+
+    const wire_t* operator->() const {
+        return this;
+    }
+
+    const std::vector<T>& getBag() const {
+        return bag;
+    }
+
+    void addMessage(const T& message) {
+        bag.push_back(message);
+    }
+
+    void clear() {
+        bag.clear();
+    }
+};
+
+//! Appends every message of from to to, as a coupling between them would
+template<typename From, typename To>
+void forward(const From& from, To& to) {
+    for(const auto& message : from->getBag()) {
+        to->addMessage(message);
+    }
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_FUSION_HPP
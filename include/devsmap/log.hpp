@@ -0,0 +1,206 @@
+/**
+ * Selective logging of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Only the models, ports and state variables named in the "log" section
+ * of the experimental frame get logging code; everything else is
+ * generated as without it. Selected models narrow their instances down at
+ * run time with a channel mask, resolved once per instance from its path,
+ * and sample every Nth event and/or at most once per simulated-time
+ * interval. Lines ("time;component;kind;name;value") go to per-thread
+ * buffers written in bulk to the file named by DEVSMAP_LOG, by
+ * Log::instance().open(), or to devsmap_log.csv.
+ *
+ *  "experimental_frame": {
+ *      "log": {
+ *          "every": 10,
+ *          "interval": 0.5,
+ *          "models": {
+ *              "counter": {"ports": ["count_out"], "state": ["count"], "components": ["counter_model"]}
+ *          }
+ *      }
+ *  }
+ *
+ * Models are atomic model names; components, paths below the model under
+ * test, default to every instance.
+ *
+ * With "keyframe": N in the log section, a logged transition writes only
+ * the selected state variables its branches assigned, as "state" lines,
+ * and every Nth logged transition of an instance writes all of them as
+ * "keyframe" lines. Assignments made by sampled out transitions are
+ * carried to the next logged event, so replaying the lines of an instance
+ * from any keyframe reconstructs its logged state at every later logged
+ * event, whatever the sampling.
+ */
+
+#ifndef DEVSMAP_LOG_HPP
+#define DEVSMAP_LOG_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include "path.hpp"
+
+namespace devsmap {
+
+//! Channels of the model logged for one instance; a null path is every instance
+struct log_selection_t {
+    const char* path;
+    uint32_t channels;
+};
+
+struct log_sampling_t {
+    uint64_t every;         //!< log one event in every, 1 for all
+    double interval;        //!< at most one event per interval of simulated time, 0 for no limit
+};
+
+class Log {
+    private:
+    struct buffer_t {
+        std::ostringstream lines;
+
+        ~buffer_t() {
+            Log::instance().flush(*this);
+        }
+    };
+
+    std::mutex mutex;
+    std::ofstream file;
+    std::string path;
+
+    Log() {
+        const char* env = std::getenv("DEVSMAP_LOG");
+        path = env ? env : "devsmap_log.csv";
+    }
+
+    void flush(buffer_t& buffer) {
+        auto lines = buffer.lines.str();
+        if(lines.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!file.is_open()) {
+            file.open(path);
+            file << "time;component;kind;name;value\n";
+        }
+        file << lines;
+        buffer.lines.str("");
+    }
+
+    public:
+    static constexpr std::streamoff capacity = 1 << 20;   //!< bytes per thread between writes
+
+    static Log& instance() {
+        static Log log;
+        return log;
+    }
+
+    //! Sets the output file, before the first line is written
+    void open(const std::string& _path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        path = _path;
+    }
+
+    static buffer_t& local() {
+        thread_local buffer_t buffer;
+        return buffer;
+    }
+
+    template<typename T>
+    void write(double time, const std::string& component, const char* kind, const char* name, const T& value) {
+        auto& buffer = local();
+        buffer.lines << time << ';' << component << ';' << kind << ';' << name << ';' << value << '\n';
+        if(buffer.lines.tellp() >= capacity) {
+            flush(buffer);
+        }
+    }
+};
+
+/**
+ * Logging state of one instance
+ */
+class log_point_t {
+    private:
+    bool resolved = false;
+    uint32_t channels = 0;
+    uint64_t events = 0;
+    uint64_t logged = 0;
+    uint32_t assigned = 0;  //!< state channels assigned since the last logged event
+    double next_sample = -std::numeric_limits<double>::infinity();
+    std::string component;
+
+    public:
+    /**
+     * Channels to log for this event at time, 0 when the instance is not
+     * selected or the event is sampled out
+     */
+    template<typename C, size_t N>
+    uint32_t sample(const C& model, const log_selection_t (&selection)[N], const log_sampling_t& sampling, double time) {
+        if(!resolved) {
+            component = relative_path(model);
+            for(auto& entry : selection) {
+                if(!entry.path || component == entry.path) {
+                    channels |= entry.channels;
+                }
+            }
+            resolved = true;
+        }
+        if(!channels || events++ % sampling.every) {
+            return 0;
+        }
+        if(sampling.interval > 0) {
+            if(time < next_sample) {
+                return 0;
+            }
+            next_sample = (std::floor(time / sampling.interval) + 1) * sampling.interval;
+        }
+        return channels;
+    }
+
+    //! Whether this logged event writes every selected state variable, one in every
+    bool keyframe(uint64_t every) {
+        return logged++ % every == 0;
+    }
+
+    //! Records the state channels a transition assigned, logged or not
+    void assign(uint32_t written) {
+        assigned |= written;
+    }
+
+    /**
+     * Channels a logged event writes: all of them at a keyframe, otherwise
+     * those assigned since the previous logged event
+     */
+    uint32_t delta(uint32_t selected, bool keyframe) {
+        uint32_t result = keyframe ? selected : selected & assigned;
+        assigned = 0;
+        return result;
+    }
+
+    const std::string& path() const {
+        return component;
+    }
+};
+
+} //namespace devsmap
+
+#endif //DEVSMAP_LOG_HPP
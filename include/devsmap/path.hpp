@@ -0,0 +1,52 @@
+/**
+ * Hierarchy paths of components in generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVSMAP_PATH_HPP
+#define DEVSMAP_PATH_HPP
+
+#include <string>
+
+namespace devsmap {
+
+/**
+ * Dotted path of a component from the top model, e.g. "top.sub.counter"
+ */
+template<typename C>
+std::string component_path(const C& component) {
+    std::string path = component.getId();
+    for(auto parent = component.getParent(); parent; parent = parent->getParent()) {
+        path = parent->getId() + "." + path;
+    }
+    return path;
+}
+
+/**
+ * Path below the top model, e.g. "sub.counter", as component names appear
+ * in the DEVSMap files; the top model's own id is chosen by the simulator
+ */
+template<typename C>
+std::string relative_path(const C& component) {
+    std::string path = component_path(component);
+    auto dot = path.find('.');
+    return dot == std::string::npos ? path : path.substr(dot + 1);
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_PATH_HPP
@@ -0,0 +1,134 @@
+/**
+ * Shared-object plugins of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * With --plugins every generated model also gets a plugin source, built
+ * into its own shared object, exporting one C function:
+ *
+ *  extern "C" const devsmap_plugin_t* devsmap_plugin();
+ *
+ * The descriptor names the model and creates it from a component id and
+ * an initial-state blob: the bytes of a trivially copyable <model>State,
+ * or nothing for the model's default state (coupled models always build
+ * the initial state they were generated with). Only this entry point is
+ * C; the model it returns is a Cadmium component, so a plugin and the
+ * simulator loading it must be built against the same Cadmium headers
+ * with the same compiler. The ABI number changes whenever the descriptor
+ * does.
+ *
+ * Simulators load plugins with devsmap::Plugin, which keeps the library
+ * loaded as long as any model it created is alive:
+ *
+ *  devsmap::Plugin plugin("plugins/counter_tester.so");
+ *  auto model = plugin.create<cadmium::Coupled>("top");
+ */
+
+#ifndef DEVSMAP_PLUGIN_HPP
+#define DEVSMAP_PLUGIN_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#define DEVSMAP_PLUGIN_ABI 1
+#define DEVSMAP_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+
+extern "C" {
+
+struct devsmap_plugin_t {
+    uint32_t abi;               //!< DEVSMAP_PLUGIN_ABI of the plugin
+    const char* model;          //!< generated model name
+    const char* kind;           //!< "atomic" or "coupled"
+    size_t state_size;          //!< size of a state blob, 0 when the model takes none
+
+    //! A new cadmium::Component, or null when the blob does not fit the model
+    void* (*create)(const char* id, const void* state, size_t size);
+    void (*destroy)(void* model);
+};
+
+}
+
+#include <dlfcn.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "cadmium/modeling/devs/component.hpp"
+
+namespace devsmap {
+
+class Plugin {
+    private:
+    std::shared_ptr<void> library;
+    const devsmap_plugin_t* descriptor;
+
+    public:
+    explicit Plugin(const std::string& path) {
+        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if(!handle) {
+            throw std::runtime_error("CANNOT LOAD PLUGIN " + path + ": " + dlerror());
+        }
+        library = std::shared_ptr<void>(handle, [](void* h) { dlclose(h); });
+
+        auto entry = reinterpret_cast<const devsmap_plugin_t* (*)()>(dlsym(handle, "devsmap_plugin"));
+        if(!entry) {
+            throw std::runtime_error("NO DEVSMAP PLUGIN IN " + path);
+        }
+        descriptor = entry();
+        if(descriptor->abi != DEVSMAP_PLUGIN_ABI) {
+            throw std::runtime_error("PLUGIN ABI " + std::to_string(descriptor->abi) + " OF " + path + " IS NOT " + std::to_string(DEVSMAP_PLUGIN_ABI));
+        }
+    }
+
+    const char* model() const {
+        return descriptor->model;
+    }
+
+    const char* kind() const {
+        return descriptor->kind;
+    }
+
+    /**
+     * A new model, T being cadmium::Component or what the model derives from
+     */
+    template<typename T = cadmium::Component>
+    std::shared_ptr<T> create(const std::string& id, const void* state = nullptr, size_t size = 0) const {
+        void* created = descriptor->create(id.c_str(), state, size);
+        if(!created) {
+            throw std::runtime_error("STATE OF " + std::to_string(size) + " BYTES DOES NOT FIT PLUGIN MODEL " + descriptor->model);
+        }
+        // destroyed by the plugin that allocated it, which stays loaded until then
+        auto keep = library;
+        auto destroy = descriptor->destroy;
+        std::shared_ptr<cadmium::Component> component(static_cast<cadmium::Component*>(created), [keep, destroy](cadmium::Component* c) { destroy(c); });
+
+        auto model = std::dynamic_pointer_cast<T>(component);
+        if(!model) {
+            throw std::runtime_error(std::string("PLUGIN MODEL ") + descriptor->model + " IS NOT A " + descriptor->kind + " OF THE REQUESTED TYPE");
+        }
+        return model;
+    }
+
+    template<typename T = cadmium::Component, typename S>
+    std::shared_ptr<T> create(const std::string& id, const S& state) const {
+        static_assert(std::is_trivially_copyable_v<S>, "plugin states are passed as raw bytes");
+        return create<T>(id, &state, sizeof(S));
+    }
+};
+
+} //namespace devsmap
+
+#endif //DEVSMAP_PLUGIN_HPP
@@ -0,0 +1,194 @@
+/**
+ * Proxy atomic models for partitioned DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * A coupling cut by the partitioner becomes a ProxyOut in the sending
+ * partition and a ProxyIn in the receiving one, joined by a channel of a
+ * ChannelHub.
+ *
+ * Synchronization is left to simulate_partition(), which replaces
+ * root.simulate(end) in the runner generated for every partition: between
+ * two events it receives frames, sends promises and runs the next event only
+ * once no remote message can precede it. The proxies never block.
+ */
+
+#ifndef DEVSMAP_PROXY_HPP
+#define DEVSMAP_PROXY_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include "cadmium/modeling/devs/atomic.hpp"
+#include "transport.hpp"
+
+namespace devsmap {
+
+using namespace cadmium;
+
+struct ProxyState {
+    double clock;
+
+    ProxyState(): clock(0) {}
+};
+inline std::ostream& operator<<(std::ostream& out, const ProxyState& s) {
+    out << "{clock:" << s.clock << "}";
+    return out;
+}
+
+//! Lets simulate_partition() tell the ProxyIn models of a partition from its own
+struct ProxyInput {
+    virtual ~ProxyInput() = default;
+};
+
+/**
+ * Replays the messages of a remote output port. It is scheduled at the next
+ * queued message or, with nothing queued, at the promise of the sender, where
+ * it wakes up without output to look again.
+ */
+template<typename T>
+class ProxyIn: public Atomic<ProxyState>, public ProxyInput {
+    private:
+    std::shared_ptr<ChannelHub> hub;
+    uint32_t channel;
+
+    public:
+    Port<T> out;
+
+    ProxyIn(const std::string id, std::shared_ptr<ChannelHub> _hub, uint32_t _channel): Atomic<ProxyState>(id, ProxyState()), hub(_hub), channel(_channel) {
+        out = addOutPort<T>("out");
+        hub->subscribe(channel);
+    }
+
+    void internalTransition(ProxyState& state) const override {
+        state.clock = hub->horizon(channel, state.clock);
+        hub->advance(channel);
+    }
+
+    void externalTransition(ProxyState& state, double e) const override {
+        state.clock += e;
+    }
+
+    void output(const ProxyState& state) const override {
+        for(auto& payload : hub->due(channel)) {
+            out->addMessage(codec<T>::decode(payload));
+        }
+    }
+
+    [[nodiscard]] double timeAdvance(const ProxyState& state) const override {
+        return hub->horizon(channel, state.clock) - state.clock;
+    }
+};
+
+/**
+ * Forwards a local output port to a remote partition, stamped with the time
+ * of the event. Passive: promises are sent by simulate_partition().
+ */
+template<typename T>
+class ProxyOut: public Atomic<ProxyState> {
+    private:
+    std::shared_ptr<ChannelHub> hub;
+    uint32_t channel;
+    size_t partition;
+
+    public:
+    Port<T> in;
+
+    ProxyOut(const std::string id, std::shared_ptr<ChannelHub> _hub, uint32_t _channel, size_t _partition): Atomic<ProxyState>(id, ProxyState()), hub(_hub), channel(_channel), partition(_partition) {
+        in = addInPort<T>("in");
+        hub->publish(partition, channel);
+    }
+
+    void internalTransition(ProxyState& state) const override {}
+
+    void externalTransition(ProxyState& state, double e) const override {
+        state.clock += e;
+        for(auto& message : in->getBag()) {
+            hub->send(partition, channel, hub->now(), codec<T>::encode(message));
+        }
+    }
+
+    void output(const ProxyState& state) const override {}
+
+    [[nodiscard]] double timeAdvance(const ProxyState& state) const override {
+        return std::numeric_limits<double>::infinity();
+    }
+};
+
+/**
+ * Next event of the models of the partition held by root that feed a cut
+ * port (sources), and of the others. ProxyIn wake-ups are left out: they
+ * only replay remote messages, accounted for by ChannelHub::earliest().
+ */
+template<typename Root>
+std::pair<double, double> next_events(Root& root, const std::set<std::string>& sources) {
+    double source_next = std::numeric_limits<double>::infinity();
+    double other_next = std::numeric_limits<double>::infinity();
+    for(auto& simulator : root.getTopCoordinator()->getSubcomponents()) {
+        auto component = simulator->getComponent();
+        if(dynamic_cast<const ProxyInput*>(component.get())) {
+            continue;
+        }
+        double& next = sources.count(component->getId()) ? source_next : other_next;
+        next = std::min(next, simulator->getTimeNext());
+    }
+    return {source_next, other_next};
+}
+
+/**
+ * Simulates the partition held by root (started at time 0) until end, in
+ * step with the other partitions of hub. sources are the ids of the models
+ * coupled to a ProxyOut.
+ *
+ * An event at t runs once every incoming channel has promised past t. After
+ * every event each outgoing channel is promised
+ *
+ *     min(next source event, min(next other event, hub.earliest()) + lookahead)
+ *
+ * where lookahead is a lower bound on the time advance of a source after any
+ * of its transitions: an output already scheduled happens at the next source
+ * event, any other one at least lookahead after whatever event causes it. It
+ * has to be strictly positive when partitions form a cycle. When done, every
+ * peer is promised infinity.
+ */
+template<typename Root>
+void simulate_partition(Root& root, ChannelHub& hub, double end, double lookahead, const std::set<std::string>& sources) {
+    while(true) {
+        hub.poll();
+        auto [source_next, other_next] = next_events(root, sources);
+        hub.promise_all(std::min(source_next, std::min(other_next, hub.earliest()) + lookahead));
+
+        double next = root.getTopCoordinator()->getTimeNext();
+        if(next >= end) {
+            break;
+        }
+        if(next < hub.safe()) {
+            hub.at(next);
+            root.simulate(1L);
+        } else {
+            hub.wait();
+        }
+    }
+    hub.finish();
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_PROXY_HPP
@@ -0,0 +1,198 @@
+/**
+ * Compile-time layout of the states and ports of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Models generated with --reflect specialize reflection<State> with the
+ * name, type, offset, size and kind of every state field, and declare
+ * their ports in a static constexpr devsmap_ports table. pack() copies a
+ * state into a buffer field by field using only that table, with no
+ * formatting; print() turns the packed bytes back into the text
+ * operator<< would have written, so tools can record states raw and
+ * format them offline.
+ *
+ * Packed layout, fields in declaration order (native endianness):
+ *   bytes fields    sizeof bytes of the value
+ *   string fields   uint32 length, characters
+ *   opaque fields   nothing
+ */
+
+#ifndef DEVSMAP_REFLECTION_HPP
+#define DEVSMAP_REFLECTION_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace devsmap {
+
+enum class field_kind_t {
+    boolean,
+    signed_integer,
+    unsigned_integer,
+    floating,
+    string,
+    bytes,      //!< other trivially copyable type, packed but printed as hex
+    opaque      //!< cannot be copied as bytes, left out of packed states
+};
+
+template<typename T>
+constexpr field_kind_t field_kind() {
+    if constexpr(std::is_same_v<T, bool>) {
+        return field_kind_t::boolean;
+    } else if constexpr(std::is_integral_v<T>) {
+        return std::is_signed_v<T> ? field_kind_t::signed_integer : field_kind_t::unsigned_integer;
+    } else if constexpr(std::is_floating_point_v<T>) {
+        return field_kind_t::floating;
+    } else if constexpr(std::is_same_v<T, std::string>) {
+        return field_kind_t::string;
+    } else if constexpr(std::is_trivially_copyable_v<T>) {
+        return field_kind_t::bytes;
+    } else {
+        return field_kind_t::opaque;
+    }
+}
+
+struct field_t {
+    const char* name;
+    const char* type;       //!< as written in the model
+    size_t offset;
+    size_t size;
+    field_kind_t kind;
+};
+
+struct port_info_t {
+    const char* name;
+    const char* type;       //!< message type as written in the model
+    size_t size;            //!< of one message
+    field_kind_t kind;
+    bool input;
+};
+
+//! Specialized by every model generated with --reflect, as static constexpr std::array<field_t, N> fields
+template<typename State>
+struct reflection;
+
+//! Bytes pack() writes for state
+template<typename State>
+size_t packed_size(const State& state) {
+    size_t size = 0;
+    for(auto& field : reflection<State>::fields) {
+        if(field.kind == field_kind_t::string) {
+            size += sizeof(uint32_t) + reinterpret_cast<const std::string*>(reinterpret_cast<const char*>(&state) + field.offset)->size();
+        } else if(field.kind != field_kind_t::opaque) {
+            size += field.size;
+        }
+    }
+    return size;
+}
+
+//! Copies the fields of state to out, which holds packed_size(state) bytes; returns the end of the written bytes
+template<typename State>
+char* pack(const State& state, char* out) {
+    const char* base = reinterpret_cast<const char*>(&state);
+    for(auto& field : reflection<State>::fields) {
+        if(field.kind == field_kind_t::string) {
+            auto& value = *reinterpret_cast<const std::string*>(base + field.offset);
+            uint32_t length = static_cast<uint32_t>(value.size());
+            std::memcpy(out, &length, sizeof(length));
+            std::memcpy(out + sizeof(length), value.data(), length);
+            out += sizeof(length) + length;
+        } else if(field.kind != field_kind_t::opaque) {
+            std::memcpy(out, base + field.offset, field.size);
+            out += field.size;
+        }
+    }
+    return out;
+}
+
+namespace detail {
+    template<typename T>
+    T load(const char* in) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        return value;
+    }
+}
+
+//! Prints one packed value of field at in, as operator<< would have; returns the end of the value
+inline const char* print_value(std::ostream& out, const field_t& field, const char* in) {
+    switch(field.kind) {
+        case field_kind_t::boolean:
+            out << detail::load<bool>(in);
+            return in + field.size;
+        case field_kind_t::signed_integer:
+            if(field.size == 1) {
+                out << detail::load<signed char>(in);
+            } else {
+                out << (field.size == 2 ? detail::load<int16_t>(in) : field.size == 4 ? detail::load<int32_t>(in) : detail::load<int64_t>(in));
+            }
+            return in + field.size;
+        case field_kind_t::unsigned_integer:
+            if(field.size == 1) {
+                out << detail::load<unsigned char>(in);
+            } else {
+                out << (field.size == 2 ? detail::load<uint16_t>(in) : field.size == 4 ? detail::load<uint32_t>(in) : detail::load<uint64_t>(in));
+            }
+            return in + field.size;
+        case field_kind_t::floating:
+            if(field.size == sizeof(float)) {
+                out << detail::load<float>(in);
+            } else if(field.size == sizeof(double)) {
+                out << detail::load<double>(in);
+            } else {
+                out << detail::load<long double>(in);
+            }
+            return in + field.size;
+        case field_kind_t::string: {
+            uint32_t length = detail::load<uint32_t>(in);
+            out.write(in + sizeof(length), length);
+            return in + sizeof(length) + length;
+        }
+        case field_kind_t::bytes: {
+            static constexpr char digits[] = "0123456789abcdef";
+            out << "0x";
+            for(size_t i = 0; i < field.size; i++) {
+                out << digits[static_cast<unsigned char>(in[i]) >> 4] << digits[static_cast<unsigned char>(in[i]) & 15];
+            }
+            return in + field.size;
+        }
+        case field_kind_t::opaque:
+            out << "?";
+            return in;
+    }
+    return in;
+}
+
+//! Prints a state packed with the given fields as {name:value, ...}; returns the end of the state
+template<size_t N>
+const char* print(std::ostream& out, const std::array<field_t, N>& fields, const char* in) {
+    out << "{";
+    for(size_t i = 0; i < N; i++) {
+        out << (i ? ", " : "") << fields[i].name << ":";
+        in = print_value(out, fields[i], in);
+    }
+    out << "}";
+    return in;
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_REFLECTION_HPP
@@ -0,0 +1,273 @@
+/**
+ * Online statistics for generated DEVSMap acceptors
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Each observed port of an acceptor keeps one statistics_t, updated per
+ * message in constant time and memory: count, mean and variance (Welford),
+ * min and max, an optional fixed-bin histogram and P-square quantile
+ * estimates (Jain and Chlamtac, 1985), five markers per quantile. Only
+ * the summary written at the end of the run leaves the simulation.
+ */
+
+#ifndef DEVSMAP_STATISTICS_HPP
+#define DEVSMAP_STATISTICS_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace devsmap {
+
+enum statistic_t : unsigned {
+    COUNT = 1,
+    MEAN = 2,
+    VARIANCE = 4,
+    MIN = 8,
+    MAX = 16
+};
+
+/**
+ * Streaming estimate of one quantile
+ */
+class p2_quantile_t {
+    private:
+    double p;
+    double q[5];            //!< marker heights
+    double n[5];            //!< marker positions
+    double desired[5];
+    double increment[5];
+    uint64_t count = 0;
+
+    double parabolic(int i, double d) const {
+        return q[i] + d / (n[i + 1] - n[i - 1]) * ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                                                   (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+    }
+
+    double linear(int i, int d) const {
+        return q[i] + d * (q[i + d] - q[i]) / (n[i + d] - n[i]);
+    }
+
+    public:
+    explicit p2_quantile_t(double _p): p(_p),
+        n{0, 1, 2, 3, 4}, desired{0, 2 * _p, 4 * _p, 2 + 2 * _p, 4}, increment{0, _p / 2, _p, (1 + _p) / 2, 1} {}
+
+    double quantile() const {
+        return p;
+    }
+
+    void push(double x) {
+        if(count < 5) {
+            q[count++] = x;
+            if(count == 5) {
+                std::sort(q, q + 5);
+            }
+            return;
+        }
+
+        int k;
+        if(x < q[0]) {
+            q[0] = x;
+            k = 0;
+        } else if(x >= q[4]) {
+            q[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while(x >= q[k + 1]) {
+                k++;
+            }
+        }
+        for(int i = k + 1; i < 5; i++) {
+            n[i]++;
+        }
+        for(int i = 0; i < 5; i++) {
+            desired[i] += increment[i];
+        }
+        count++;
+
+        for(int i = 1; i < 4; i++) {
+            double d = desired[i] - n[i];
+            if((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+                int step = d > 0 ? 1 : -1;
+                double candidate = parabolic(i, step);
+                q[i] = (q[i - 1] < candidate && candidate < q[i + 1]) ? candidate : linear(i, step);
+                n[i] += step;
+            }
+        }
+    }
+
+    //! Exact below five samples, NaN without any
+    double value() const {
+        if(count == 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if(count < 5) {
+            double sorted[5];
+            std::copy(q, q + count, sorted);
+            std::sort(sorted, sorted + count);
+            return sorted[static_cast<size_t>(std::lround(p * (count - 1)))];
+        }
+        return q[2];
+    }
+};
+
+struct histogram_t {
+    double low = 0;
+    double high = 0;
+    std::vector<uint64_t> bins;
+    uint64_t underflow = 0;
+    uint64_t overflow = 0;
+
+    void push(double x) {
+        if(x < low) {
+            underflow++;
+        } else if(x >= high) {
+            overflow++;
+        } else {
+            bins[std::min(bins.size() - 1, static_cast<size_t>((x - low) / (high - low) * bins.size()))]++;
+        }
+    }
+};
+
+class statistics_t {
+    private:
+    unsigned fields = 0;
+    uint64_t count = 0;
+    double mean = 0;
+    double m2 = 0;
+    double low = std::numeric_limits<double>::infinity();
+    double high = -std::numeric_limits<double>::infinity();
+    std::vector<histogram_t> histograms;        //!< none or one
+    std::vector<p2_quantile_t> quantiles;
+
+    //! Shortest round-trip form, null when not finite
+    static void write_number(std::ostream& out, double value) {
+        if(!std::isfinite(value)) {
+            out << "null";
+            return;
+        }
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.write(buffer, result.ptr - buffer);
+    }
+
+    public:
+    //! Selects the statistic_t fields of the summary
+    void report(unsigned _fields) {
+        fields = _fields;
+    }
+
+    void histogram(double low, double high, size_t bins) {
+        histograms.assign(1, histogram_t{low, high, std::vector<uint64_t>(bins, 0)});
+    }
+
+    void quantile(double p) {
+        quantiles.emplace_back(p);
+    }
+
+    void push(double x) {
+        count++;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        low = std::min(low, x);
+        high = std::max(high, x);
+        for(auto& h : histograms) {
+            h.push(x);
+        }
+        for(auto& q : quantiles) {
+            q.push(x);
+        }
+    }
+
+    uint64_t size() const {
+        return count;
+    }
+
+    //! Sample variance
+    double variance() const {
+        return count > 1 ? m2 / (count - 1) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    //! The summary as a JSON object; empty statistics are null
+    void write(std::ostream& out) const {
+        const char* separator = "";
+        auto field = [&](const char* name) {
+            out << separator << "\"" << name << "\": ";
+            separator = ", ";
+        };
+
+        out << "{";
+        if(fields & COUNT) {
+            field("count");
+            out << count;
+        }
+        if(fields & MEAN) {
+            field("mean");
+            write_number(out, count ? mean : std::numeric_limits<double>::quiet_NaN());
+        }
+        if(fields & VARIANCE) {
+            field("variance");
+            write_number(out, variance());
+        }
+        if(fields & MIN) {
+            field("min");
+            write_number(out, low);
+        }
+        if(fields & MAX) {
+            field("max");
+            write_number(out, high);
+        }
+        for(auto& h : histograms) {
+            field("histogram");
+            out << "{\"min\": ";
+            write_number(out, h.low);
+            out << ", \"max\": ";
+            write_number(out, h.high);
+            out << ", \"underflow\": " << h.underflow << ", \"overflow\": " << h.overflow << ", \"bins\": [";
+            for(size_t i = 0; i < h.bins.size(); i++) {
+                out << (i ? ", " : "") << h.bins[i];
+            }
+            out << "]}";
+        }
+        if(!quantiles.empty()) {
+            field("quantiles");
+            out << "{";
+            for(size_t i = 0; i < quantiles.size(); i++) {
+                out << (i ? ", " : "") << "\"";
+                write_number(out, quantiles[i].quantile());
+                out << "\": ";
+                write_number(out, quantiles[i].value());
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+};
+
+//! Compact form for Cadmium's state loggers
+inline std::ostream& operator<<(std::ostream& out, const statistics_t& s) {
+    return out << "n=" << s.size();
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_STATISTICS_HPP
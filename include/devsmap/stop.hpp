@@ -0,0 +1,120 @@
+/**
+ * Early termination of simulations of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Stop predicates are declared per atomic model in the experimental
+ * frame, in the expression language of the model:
+ *
+ *  "experimental_frame": {
+ *      "stop": {
+ *          "counter": ["count >= 100", "count_out.bagSize() != 0 && count_out.bag(-1) < 0"]
+ *      }
+ *  }
+ *
+ * A predicate over state variables is checked after every transition of
+ * the model, one reading output ports after every output. Each check is
+ * the compiled condition; only a satisfied one calls Stop::request(),
+ * which keeps the earliest time, component and predicate.
+ *
+ * devsmap::simulate(root, end) replaces root.simulate(end): it runs one
+ * event at a time and returns after the first event that satisfied a
+ * predicate, so the rest of the time span is never simulated.
+ */
+
+#ifndef DEVSMAP_STOP_HPP
+#define DEVSMAP_STOP_HPP
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <string>
+#include "path.hpp"
+
+namespace devsmap {
+
+class Stop {
+    private:
+    std::mutex mutex;
+    std::atomic<bool> stopped = false;
+    double stop_time = std::numeric_limits<double>::infinity();
+    std::string stop_component;
+    std::string stop_predicate;
+
+    Stop() = default;
+
+    public:
+    static Stop& instance() {
+        static Stop stop;
+        return stop;
+    }
+
+    //! Whether a predicate was satisfied since the last reset()
+    bool requested() const {
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+    template<typename C>
+    void request(double time, const C& component, const char* predicate) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!stopped || time < stop_time) {
+            stop_time = time;
+            stop_component = component_path(component);
+            stop_predicate = predicate;
+        }
+        stopped = true;
+    }
+
+    double time() const {
+        return stop_time;
+    }
+
+    const std::string& component() const {
+        return stop_component;
+    }
+
+    const std::string& predicate() const {
+        return stop_predicate;
+    }
+
+    //! Forgets the last stop, before simulating another model in the same process
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = false;
+        stop_time = std::numeric_limits<double>::infinity();
+        stop_component.clear();
+        stop_predicate.clear();
+    }
+};
+
+/**
+ * Simulates events before end, as root.simulate(end) on a root started at
+ * time 0, until one satisfies a stop predicate
+ *
+ * @return whether a predicate stopped the simulation, see Stop::instance()
+ */
+template<typename Root>
+bool simulate(Root& root, double end) {
+    auto& stop = Stop::instance();
+    while(!stop.requested() && root.getTopCoordinator()->getTimeNext() < end) {
+        root.simulate(1L);
+    }
+    return stop.requested();
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_STOP_HPP
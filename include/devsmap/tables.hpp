@@ -0,0 +1,58 @@
+/**
+ * Table-driven construction of generated DEVSMap coupled models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * In table mode a generated coupled model keeps its components and
+ * couplings in constexpr arrays of these entries and builds itself with
+ * a loop, so its constructor does not grow with the model.
+ */
+
+#ifndef DEVSMAP_TABLES_HPP
+#define DEVSMAP_TABLES_HPP
+
+#include <cstddef>
+
+namespace devsmap {
+
+struct component_entry_t {
+    const char* id;
+    int state;                  //!< index into the model's distinct initial states, -1 for none
+};
+
+struct coupling_entry_t {
+    const char* component_from; //!< nullptr for an input port of the coupled model itself (EIC)
+    const char* port_from;
+    const char* component_to;   //!< nullptr for an output port of the coupled model itself (EOC)
+    const char* port_to;
+};
+
+/**
+ * Adds every coupling of the table to model, looking components and ports
+ * up by name
+ */
+template<typename C, size_t N>
+void add_couplings(C& model, const coupling_entry_t (&table)[N]) {
+    for(auto& entry : table) {
+        auto from = entry.component_from ? model.getComponent(entry.component_from)->getOutPort(entry.port_from) : model.getInPort(entry.port_from);
+        auto to = entry.component_to ? model.getComponent(entry.component_to)->getInPort(entry.port_to) : model.getOutPort(entry.port_to);
+        model.addCoupling(from, to);
+    }
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_TABLES_HPP
@@ -0,0 +1,69 @@
+/**
+ * Integer time base of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Models generated with --time-resolution N count time in ticks of 1/N
+ * units. Their time advance is computed in ticks, literal ones converted
+ * when the model is generated, and elapsed times are snapped to the tick
+ * grid; Cadmium still sees double times at its interface. Populations
+ * schedule in ticks throughout, so ties are exact integer comparisons.
+ */
+
+#ifndef DEVSMAP_TIME_HPP
+#define DEVSMAP_TIME_HPP
+
+#include <cstdint>
+#include <limits>
+
+namespace devsmap {
+
+using tick_t = int64_t;
+
+//! Passive: no next event. Sums saturate on it, see advance()
+constexpr tick_t tick_infinity = std::numeric_limits<tick_t>::max();
+
+/**
+ * Nearest tick to time t, ties to even; infinity, and anything too large
+ * to count, is tick_infinity. constexpr so tabulated models can use it.
+ */
+constexpr tick_t to_ticks(double t, tick_t resolution) {
+    double scaled = t * static_cast<double>(resolution);
+    if(scaled >= static_cast<double>(tick_infinity)) {
+        return tick_infinity;
+    }
+    tick_t whole = static_cast<tick_t>(scaled);
+    double fraction = scaled - static_cast<double>(whole);
+    if(fraction > 0.5 || (fraction == 0.5 && whole % 2 != 0)) {
+        whole++;
+    } else if(fraction < -0.5 || (fraction == -0.5 && whole % 2 != 0)) {
+        whole--;
+    }
+    return whole;
+}
+
+constexpr double to_time(tick_t ticks, tick_t resolution) {
+    return ticks == tick_infinity ? std::numeric_limits<double>::infinity() : static_cast<double>(ticks) / static_cast<double>(resolution);
+}
+
+//! Next event time from the last one and a time advance, tick_infinity stays passive
+constexpr tick_t advance(tick_t last, tick_t sigma) {
+    return sigma == tick_infinity ? tick_infinity : last + sigma;
+}
+
+} //namespace devsmap
+
+#endif //DEVSMAP_TIME_HPP
@@ -0,0 +1,215 @@
+/**
+ * Chrome trace-event output of generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Models generated with --trace record every transition and output as a
+ * complete ("X") trace event: wall-clock start and duration, with the
+ * simulated time in args. Each component gets its own track, named after
+ * its path in the coupled hierarchy; each simulating thread is a process
+ * of the trace. The file loads in chrome://tracing and ui.perfetto.dev.
+ *
+ * Tracing is off until Tracer::instance().open(path) is called, or the
+ * DEVSMAP_TRACE environment variable names the output file; while off, a
+ * traced transition costs one branch. Events are kept in per-thread
+ * buffers and written in bulk when a buffer fills, when its thread ends
+ * and at exit.
+ */
+
+#ifndef DEVSMAP_TRACE_HPP
+#define DEVSMAP_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "path.hpp"
+
+namespace devsmap {
+
+struct trace_event_t {
+    const char* phase;      //!< "internal", "external", "confluent" or "output"
+    uint32_t track;
+    double time;            //!< simulated
+    int64_t start_ns;       //!< wall clock, since the tracer started
+    int64_t duration_ns;
+};
+
+class Tracer {
+    private:
+    struct buffer_t {
+        std::vector<trace_event_t> events;
+        uint32_t thread;
+
+        buffer_t() {
+            events.reserve(capacity);
+            thread = Tracer::instance().next_thread++;
+        }
+
+        ~buffer_t() {
+            Tracer::instance().flush(*this);
+        }
+    };
+
+    std::mutex mutex;
+    std::FILE* file = nullptr;
+    bool first = true;
+    std::vector<std::string> tracks;
+    std::atomic<uint32_t> next_thread{1};
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    Tracer() {
+        if(const char* path = std::getenv("DEVSMAP_TRACE")) {
+            open(path);
+        }
+    }
+
+    // thread buffers, the main thread's included, are gone and flushed by now
+    ~Tracer() {
+        enabled = false;
+        finish();
+    }
+
+    void flush(buffer_t& buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(file) {
+            for(auto& e : buffer.events) {
+                std::fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"devsmap\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"t\":%.17g}}",
+                    first ? "" : ",\n", e.phase, buffer.thread, e.track, e.start_ns / 1000.0, e.duration_ns / 1000.0, e.time);
+                first = false;
+            }
+        }
+        buffer.events.clear();
+    }
+
+    void finish() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!file) {
+            return;
+        }
+        for(uint32_t thread = 1; thread < next_thread; thread++) {
+            for(uint32_t track = 0; track < tracks.size(); track++) {
+                std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n", thread, track, tracks[track].c_str());
+                first = false;
+            }
+        }
+        std::fputs("\n]}\n", file);
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    public:
+    static constexpr size_t capacity = 1 << 16;    //!< events per thread between writes
+    static constexpr uint32_t unregistered = UINT32_MAX;
+
+    std::atomic<bool> enabled{false};
+
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(file) {
+            return;
+        }
+        file = std::fopen(path.c_str(), "w");
+        if(file) {
+            std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+            enabled = true;
+        }
+    }
+
+    //! Writes the calling thread's events and the track names, then ends the file
+    void close() {
+        enabled = false;
+        flush(local());
+        finish();
+    }
+
+    uint32_t track(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        tracks.push_back(name);
+        return static_cast<uint32_t>(tracks.size() - 1);
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    static buffer_t& local() {
+        thread_local buffer_t buffer;
+        return buffer;
+    }
+
+    void record(const trace_event_t& event) {
+        auto& buffer = local();
+        buffer.events.push_back(event);
+        if(buffer.events.size() == capacity) {
+            flush(buffer);
+        }
+    }
+};
+
+/**
+ * Track of one component, registered on its first traced event (parents
+ * are only known once the model is fully built)
+ */
+struct trace_track_t {
+    uint32_t id = Tracer::unregistered;
+
+    template<typename C>
+    uint32_t get(const C& component) {
+        if(id == Tracer::unregistered) {
+            id = Tracer::instance().track(component_path(component));
+        }
+        return id;
+    }
+};
+
+/**
+ * Times the enclosing block as one event of a component
+ */
+class trace_scope_t {
+    private:
+    bool active;
+    trace_event_t event;
+
+    public:
+    template<typename C>
+    trace_scope_t(trace_track_t& track, const C& component, const char* phase, double time): active(Tracer::instance().enabled.load(std::memory_order_relaxed)) {
+        if(active) {
+            event = {phase, track.get(component), time, Tracer::instance().now(), 0};
+        }
+    }
+
+    ~trace_scope_t() {
+        if(active) {
+            event.duration_ns = Tracer::instance().now() - event.start_ns;
+            Tracer::instance().record(event);
+        }
+    }
+};
+
+} //namespace devsmap
+
+#endif //DEVSMAP_TRACE_HPP
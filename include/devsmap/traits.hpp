@@ -0,0 +1,43 @@
+/**
+ * Static model traits shared by generated DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DEVSMAP_TRAITS_HPP
+#define DEVSMAP_TRAITS_HPP
+
+namespace devsmap {
+
+/**
+ * Classification of a model's time advance, exposed by every generated
+ * atomic model as
+ *  - static constexpr TimeAdvance ta_kind
+ *  - static constexpr double ta_constant       (CONSTANT and PASSIVE only)
+ *  - static constexpr bool ta_may_passivate
+ *  - static constexpr double ta_min_lookahead  (0 when unknown)
+ */
+enum class TimeAdvance {
+    CONSTANT,
+    PARAMETER,
+    STATE_DEPENDENT,
+    PASSIVE
+};
+
+} //namespace devsmap
+
+#endif //DEVSMAP_TRAITS_HPP
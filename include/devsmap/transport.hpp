@@ -0,0 +1,393 @@
+/**
+ * Inter-partition transport for partitioned DEVSMap models
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DEVSMAP_TRANSPORT_HPP
+#define DEVSMAP_TRANSPORT_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace devsmap {
+
+/**
+ * Byte encoding of port messages. Trivially copyable types are copied as is,
+ * std::string is sent verbatim.
+ */
+template<typename T>
+struct codec {
+    static_assert(std::is_trivially_copyable_v<T>, "codec<T> needs a specialization for non trivially copyable T");
+
+    static std::string encode(const T& value) {
+        std::string bytes(sizeof(T), '\0');
+        std::memcpy(bytes.data(), &value, sizeof(T));
+        return bytes;
+    }
+
+    static T decode(const std::string& bytes) {
+        T value;
+        std::memcpy(&value, bytes.data(), sizeof(T));
+        return value;
+    }
+};
+
+template<>
+struct codec<std::string> {
+    static std::string encode(const std::string& value) { return value; }
+    static std::string decode(const std::string& bytes) { return bytes; }
+};
+
+/**
+ * Moves opaque frames between the processes of a partitioned simulation
+ */
+class Transport {
+    public:
+    virtual ~Transport() = default;
+
+    //! Queues frame for partition; never waits for the peer to read
+    virtual void send(size_t partition, const std::string& frame) = 0;
+
+    //! Takes a frame addressed to this partition if one has arrived
+    virtual bool try_receive(std::string& frame) = 0;
+
+    //! Blocks until a frame addressed to this partition arrives
+    virtual std::string receive() = 0;
+};
+
+/**
+ * Default transport: one AF_UNIX datagram socket per partition, bound to
+ * <directory>/part<k>.sock. Datagrams on local sockets are reliable and keep
+ * the order of a single sender, which is all the channel protocol needs.
+ *
+ * Frames are at most max_frame bytes; send() rejects larger ones instead of
+ * letting the receiver truncate them. Frames a peer cannot take yet (not
+ * bound, or a full queue) stay pending in order and are retried whenever
+ * this partition sends or receives, so two partitions sending to each other
+ * never wait on one another.
+ *
+ * A socket stays in the directory after its partition is done: a peer that
+ * is missing (ENOENT) has not started yet and gets its frames eventually, one
+ * that refuses them (ECONNREFUSED) has finished and no longer needs them.
+ * Every run therefore needs a directory without sockets of an earlier run.
+ */
+class UnixSocketTransport : public Transport {
+    public:
+    static constexpr size_t max_frame = 1 << 16;
+
+    private:
+    int fd;
+    std::string directory;
+    std::string own_path;
+    std::map<size_t, std::deque<std::string>> pending;
+
+    static sockaddr_un address(const std::string& path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("SOCKET PATH TOO LONG: " + path);
+        }
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        return addr;
+    }
+
+    std::string path_of(size_t partition) const {
+        return directory + "/part" + std::to_string(partition) + ".sock";
+    }
+
+    public:
+    UnixSocketTransport(const std::string& _directory, size_t partition): directory(_directory) {
+        fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if(fd < 0) {
+            throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+        }
+
+        own_path = path_of(partition);
+        unlink(own_path.c_str());
+        auto addr = address(own_path);
+        if(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw std::runtime_error("bind " + own_path + ": " + std::strerror(errno));
+        }
+    }
+
+    ~UnixSocketTransport() override {
+        // frames still pending (the final promises among them) go out before the socket closes
+        try {
+            while(std::any_of(pending.begin(), pending.end(), [](auto& p) { return !p.second.empty(); })) {
+                flush(true);
+                ::poll(nullptr, 0, 1);
+            }
+        } catch(const std::exception&) {}
+        close(fd);
+    }
+
+    /**
+     * Sends the pending frames of every peer, in order, until one would block.
+     * When closing, frames to a peer that has finished are dropped.
+     */
+    void flush(bool closing = false) {
+        for(auto& [partition, frames] : pending) {
+            auto addr = address(path_of(partition));
+            while(!frames.empty()) {
+                auto& frame = frames.front();
+                if(sendto(fd, frame.data(), frame.size(), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                    // peers may not have bound their socket yet, or may have a full queue
+                    if(errno != ENOENT && errno != ECONNREFUSED && errno != EAGAIN && errno != ENOBUFS && errno != EINTR) {
+                        throw std::runtime_error("sendto " + path_of(partition) + ": " + std::strerror(errno));
+                    }
+                    if(closing && errno == ECONNREFUSED) {
+                        frames.clear();
+                    }
+                    break;
+                }
+                frames.pop_front();
+            }
+        }
+    }
+
+    void send(size_t partition, const std::string& frame) override {
+        if(frame.size() > max_frame) {
+            throw std::runtime_error("FRAME OF " + std::to_string(frame.size()) + " BYTES TO PARTITION " + std::to_string(partition) + " EXCEEDS THE " + std::to_string(max_frame) + " BYTE LIMIT");
+        }
+        pending[partition].push_back(frame);
+        flush();
+    }
+
+    bool try_receive(std::string& frame) override {
+        frame.resize(max_frame);
+        ssize_t n;
+        // MSG_TRUNC returns the full datagram length, so an oversized frame is detected instead of cut
+        while((n = recv(fd, frame.data(), frame.size(), MSG_DONTWAIT | MSG_TRUNC)) < 0) {
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                return false;
+            }
+            if(errno != EINTR) {
+                throw std::runtime_error(std::string("recv: ") + std::strerror(errno));
+            }
+        }
+        if(static_cast<size_t>(n) > max_frame) {
+            throw std::runtime_error("RECEIVED A FRAME OF " + std::to_string(n) + " BYTES, OVER THE " + std::to_string(max_frame) + " BYTE LIMIT");
+        }
+        frame.resize(n);
+        return true;
+    }
+
+    std::string receive() override {
+        std::string frame;
+        while(true) {
+            flush();
+            if(try_receive(frame)) {
+                return frame;
+            }
+            // wake up now and then to retry pending frames, otherwise sleep until something arrives
+            bool waiting = std::any_of(pending.begin(), pending.end(), [](auto& p) { return !p.second.empty(); });
+            pollfd readable{fd, POLLIN, 0};
+            if(::poll(&readable, 1, waiting ? 1 : -1) < 0 && errno != EINTR) {
+                throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+            }
+        }
+    }
+};
+
+/**
+ * Timestamped channels on top of a Transport, with conservative (null
+ * message) synchronization. Every channel has a single sender, whose frames
+ * carry non decreasing times. A promise frame with time t guarantees that no
+ * message earlier than t will follow on that channel.
+ *
+ * Nothing here blocks but wait(): the partition runner (simulate_partition
+ * in proxy.hpp) receives frames between events and only lets the coordinator
+ * run events earlier than safe(), so the proxies read channels that are
+ * already up to date.
+ */
+class ChannelHub {
+    private:
+    enum class FrameKind : uint8_t { MESSAGE, PROMISE };
+
+    struct header_t {
+        uint32_t channel;
+        FrameKind kind;
+        double time;
+    };
+
+    struct channel_t {
+        std::deque<std::pair<double, std::string>> queue;
+        double promised = 0;
+        double wake = -1; //!< time handed out by horizon(), until advance()
+    };
+
+    std::shared_ptr<Transport> transport;
+    std::unordered_map<uint32_t, channel_t> incoming;
+    std::map<std::pair<size_t, uint32_t>, double> outgoing; //!< (partition, channel) -> last promise sent
+    double current = 0;
+
+    void send_frame(size_t partition, uint32_t channel, FrameKind kind, double time, const std::string& payload) {
+        header_t header{channel, kind, time};
+        std::string frame(sizeof(header_t), '\0');
+        std::memcpy(frame.data(), &header, sizeof(header_t));
+        frame += payload;
+        transport->send(partition, frame);
+    }
+
+    void deliver(const std::string& frame) {
+        if(frame.size() < sizeof(header_t)) {
+            throw std::runtime_error("RECEIVED A FRAME OF " + std::to_string(frame.size()) + " BYTES, SHORTER THAN ITS HEADER");
+        }
+        header_t header;
+        std::memcpy(&header, frame.data(), sizeof(header_t));
+
+        auto& c = incoming[header.channel];
+        if(header.kind == FrameKind::MESSAGE) {
+            c.queue.emplace_back(header.time, frame.substr(sizeof(header_t)));
+        }
+        c.promised = std::max(c.promised, header.time);
+    }
+
+    public:
+    explicit ChannelHub(std::shared_ptr<Transport> _transport): transport(std::move(_transport)) {}
+
+    void publish(size_t partition, uint32_t channel) {
+        outgoing.emplace(std::make_pair(partition, channel), -std::numeric_limits<double>::infinity());
+    }
+
+    void subscribe(uint32_t channel) {
+        incoming[channel];
+    }
+
+    //! Time of the event the coordinator is running, set by the runner
+    void at(double time) {
+        current = time;
+    }
+
+    double now() const {
+        return current;
+    }
+
+    void send(size_t partition, uint32_t channel, double time, const std::string& payload) {
+        send_frame(partition, channel, FrameKind::MESSAGE, time, payload);
+    }
+
+    void promise(size_t partition, uint32_t channel, double time) {
+        send_frame(partition, channel, FrameKind::PROMISE, time, "");
+    }
+
+    //! Promises time on every outgoing channel where it is later than the last promise
+    void promise_all(double time) {
+        for(auto& [endpoint, promised] : outgoing) {
+            if(time > promised) {
+                promise(endpoint.first, endpoint.second, time);
+                promised = time;
+            }
+        }
+    }
+
+    //! Takes every frame that has already arrived
+    void poll() {
+        std::string frame;
+        while(transport->try_receive(frame)) {
+            deliver(frame);
+        }
+    }
+
+    //! Blocks until one more frame arrives
+    void wait() {
+        deliver(transport->receive());
+    }
+
+    //! Events strictly earlier than this can no longer be preceded by a remote message
+    double safe() const {
+        double time = std::numeric_limits<double>::infinity();
+        for(auto& [channel, c] : incoming) {
+            time = std::min(time, c.promised);
+        }
+        return time;
+    }
+
+    //! Earliest time a remote message can still act here: queued or yet to come
+    double earliest() const {
+        double time = std::numeric_limits<double>::infinity();
+        for(auto& [channel, c] : incoming) {
+            time = std::min(time, c.queue.empty() ? c.promised : c.queue.front().first);
+        }
+        return time;
+    }
+
+    /**
+     * Time of the next event on channel at or after now: the next queued
+     * message, or the promised time (at least now) if nothing is queued. Any
+     * message received later is no earlier, so the value stays valid and is
+     * kept until advance().
+     */
+    double horizon(uint32_t channel, double now) {
+        auto& c = incoming[channel];
+        if(c.wake < 0) {
+            c.wake = c.queue.empty() ? std::max(c.promised, now) : c.queue.front().first;
+        }
+        return c.wake;
+    }
+
+    //! Payloads queued on channel for exactly the current horizon
+    std::vector<std::string> due(uint32_t channel) const {
+        std::vector<std::string> payloads;
+        auto it = incoming.find(channel);
+        if(it == incoming.end()) {
+            return payloads;
+        }
+        for(auto& [time, payload] : it->second.queue) {
+            if(time != it->second.wake) {
+                break;
+            }
+            payloads.push_back(payload);
+        }
+        return payloads;
+    }
+
+    //! Drops the messages returned by due() and releases the horizon
+    void advance(uint32_t channel) {
+        auto& c = incoming[channel];
+        while(!c.queue.empty() && c.queue.front().first == c.wake) {
+            c.queue.pop_front();
+        }
+        c.wake = -1;
+    }
+
+    //! Tells every peer this partition is done, so nobody waits on it forever
+    void finish() {
+        promise_all(std::numeric_limits<double>::infinity());
+    }
+};
+
+} //namespace devsmap
+
+#endif //DEVSMAP_TRANSPORT_HPP
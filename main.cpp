@@ -1,16 +1,137 @@
 #include <iostream>
+#include <optional>
+#include <thread>
 #include "CadmiumAtomicParser.hpp"
 #include "CadmiumCoupledParser.hpp"
 #include "DEVSMap_Parser.hpp"
+#include "UnityBuild.hpp"
+#include "Footprint.hpp"
+#include "Validator.hpp"
+#include "Acceptor.hpp"
+#include "PluginBuild.hpp"
 
 int main(int argc, char** argv) {
 
-    if(argc < 3) {
-        std::cerr << "Error: Too few arguments. Typical usage:\n" << argv[0] << " <Path to Experiment JSON file> <Output directory>" << std::endl;
+    std::vector<std::string> args;
+    bool profile = false;
+    bool footprint = false;
+    bool plugins = false;
+    std::vector<std::string> populations;
+    codegen_options_t options;
+    for(int i = 1; i < argc; i++) {
+        if(std::string(argv[i]) == "--profile") {
+            profile = true;
+        } else if(std::string(argv[i]) == "--unity") {
+            options.unity = true;
+        } else if(std::string(argv[i]) == "--checkpoint") {
+            options.checkpoint = true;
+        } else if(std::string(argv[i]) == "--tables") {
+            options.tables = true;
+        } else if(std::string(argv[i]) == "--trace") {
+            options.trace = true;
+        } else if(std::string(argv[i]) == "--allocations") {
+            options.allocations = true;
+        } else if(std::string(argv[i]) == "--reflect") {
+            options.reflect = true;
+        } else if(std::string(argv[i]) == "--buckets") {
+            options.buckets = true;
+        } else if(std::string(argv[i]) == "--prune-ports") {
+            options.prune = true;
+        } else if(std::string(argv[i]) == "--tabulate") {
+            options.tabulate = true;
+        } else if(std::string(argv[i]) == "--tabulate-limit" && i + 1 < argc) {
+            options.tabulate_limit = std::stoul(argv[++i]);
+        } else if(std::string(argv[i]) == "--jobs" && i + 1 < argc) {
+            options.jobs = std::stoul(argv[++i]);
+            if(options.jobs == 0) {
+                options.jobs = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if(std::string(argv[i]) == "--fuse-profile" && i + 1 < argc) {
+            options.fuse_profile = argv[++i];
+        } else if(std::string(argv[i]) == "--fuse-threshold" && i + 1 < argc) {
+            options.fuse_threshold = std::stoul(argv[++i]);
+        } else if(std::string(argv[i]) == "--plugins") {
+            plugins = true;
+        } else if(std::string(argv[i]) == "--footprint") {
+            footprint = true;
+        } else if(std::string(argv[i]) == "--state-budget" && i + 1 < argc) {
+            options.state_budget = std::stoul(argv[++i]);
+        } else if(std::string(argv[i]) == "--time-resolution" && i + 1 < argc) {
+            options.time_resolution = std::stoll(argv[++i]);
+        } else if(std::string(argv[i]) == "--population" && i + 1 < argc) {
+            populations.push_back(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if(args.size() < 2) {
+        std::cerr << "Error: Too few arguments. Typical usage:\n" << argv[0] << " <Path to Experiment JSON file> <Output directory> [--profile] [--unity] [--checkpoint] [--tables] [--trace] [--allocations] [--plugins] [--population <atomic model>]... [--footprint] [--state-budget <bytes>] [--time-resolution <ticks per time unit>] [--tabulate] [--tabulate-limit <states>] [--jobs <threads, 0 for all>] [--prune-ports] [--buckets] [--reflect] [--fuse-profile <devsmap log>] [--fuse-threshold <messages>]" << std::endl;
         return 0;
     }
 
-    Parser<CadmiumAtomicParser, CadmiumCoupledParser> parser(argv[1], argv[2]);
+    Profiler::instance().enabled = profile;
+
+    Parser<CadmiumAtomicParser, CadmiumCoupledParser> parser(args[0], options);
+
+    // a broken coupling, stop predicate, log selection or acceptor would otherwise only surface when the headers are compiled; nothing is written before
+    auto errors = Validator<CadmiumAtomicParser, CadmiumCoupledParser>(parser).run();
+    std::optional<Acceptor<CadmiumAtomicParser, CadmiumCoupledParser>> acceptor;
+    if(Acceptor<CadmiumAtomicParser, CadmiumCoupledParser>::requested(parser)) {
+        acceptor.emplace(parser);
+        errors.insert(errors.end(), acceptor->diagnostics().begin(), acceptor->diagnostics().end());
+    }
+    if(!errors.empty()) {
+        for(auto& error : errors) {
+            std::cerr << error << std::endl;
+        }
+        std::cerr << errors.size() << " VALIDATION ERROR(S)" << std::endl;
+        return 1;
+    }
+
+    parser.write(args[1]);
+
+    if(acceptor) {
+        acceptor->write(args[1]);
+    }
+
+    if(options.unity) {
+        UnityBuild<CadmiumAtomicParser, CadmiumCoupledParser>(parser).write(args[1]);
+    }
+
+    if(plugins) {
+        PluginBuild<CadmiumAtomicParser, CadmiumCoupledParser>(parser).write(args[1]);
+    }
+
+    for(auto& name : populations) {
+        auto atomic = parser.atomic(name);
+        if(!atomic) {
+            std::cerr << "NO ATOMIC MODEL " << name << " FOR A POPULATION" << std::endl;
+            continue;
+        }
+        std::ofstream file(args[1] + "/include/" + name + "_population.hpp");
+        file << atomic->make_population() << std::endl;
+        file.close();
+    }
+
+    if(options.prune) {
+        std::ofstream file(args[1] + "/pruned_ports.txt");
+        for(auto& line : parser.pruned_ports()) {
+            file << line << "\n";
+        }
+        std::cout << parser.pruned_port_count() << " port(s) pruned, see " << args[1] << "/pruned_ports.txt" << std::endl;
+    }
+
+    if(footprint) {
+        Footprint<CadmiumAtomicParser, CadmiumCoupledParser>(parser).write(args[1] + "/footprint.json");
+        std::cout << "Footprint written to " << args[1] << "/footprint.json" << std::endl;
+    }
+
+    if(profile) {
+        Profiler::instance().enabled = false;
+        Profiler::instance().write(args[1] + "/profile.json", args[1] + "/profile.folded");
+        std::cout << "Profile written to " << args[1] << "/profile.json and " << args[1] << "/profile.folded" << std::endl;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
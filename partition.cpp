@@ -0,0 +1,35 @@
+#include <iostream>
+#include "CadmiumAtomicParser.hpp"
+#include "CadmiumCoupledParser.hpp"
+#include "DEVSMap_Parser.hpp"
+#include "Partitioner.hpp"
+#include "Validator.hpp"
+
+int main(int argc, char** argv) {
+
+    if(argc < 4) {
+        std::cerr << "Error: Too few arguments. Typical usage:\n" << argv[0] << " <Path to Experiment JSON file> <Output directory> <Number of partitions> [lookahead]" << std::endl;
+        return 0;
+    }
+
+    Parser<CadmiumAtomicParser, CadmiumCoupledParser> parser(argv[1]);
+
+    auto errors = Validator<CadmiumAtomicParser, CadmiumCoupledParser>(parser).run();
+    if(!errors.empty()) {
+        for(auto& error : errors) {
+            std::cerr << error << std::endl;
+        }
+        std::cerr << errors.size() << " VALIDATION ERROR(S)" << std::endl;
+        return 1;
+    }
+
+    parser.write(argv[2]);
+
+    double lookahead = (argc > 4) ? std::stod(argv[4]) : 1.0;
+    Partitioner<CadmiumAtomicParser, CadmiumCoupledParser> partitioner(parser, std::stoul(argv[3]), lookahead);
+    partitioner.write(argv[2]);
+
+    std::cout << "Cut couplings: " << partitioner.cut() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * counter_tester fused against counter_tester plain
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * The build generates counter_tester twice with main: as it is, and with
+ * the "fuse" hint of tests/fusion_replay, which turns counter_model and
+ * generator_model into one atomic. A driver flips the counting direction
+ * at times that fall on the members' own events, so the fused model sees
+ * members imminent together and inputs arriving with an internal event,
+ * and a sink takes what the model sends. Both runs must log the same
+ * driver and sink states at the same times, and the fused model the
+ * states the two members log in the plain run whenever either transitions.
+ *
+ * Needs Cadmium (the CADMIUM environment variable at configure time);
+ * without it the test is skipped.
+ */
+
+#if __has_include("cadmium/simulation/root_coordinator.hpp")
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "cadmium/modeling/devs/coupled.hpp"
+#include "cadmium/simulation/logger/logger.hpp"
+#include "cadmium/simulation/root_coordinator.hpp"
+#include "plain/include/counter_tester.hpp"
+#include "fused/include/counter_tester_fused.hpp"
+
+using namespace cadmium;
+
+constexpr double end_time = 20.5;
+
+//! Waits between direction flips, most of which fall on the members' events at whole times
+constexpr double driver_sigmas[] = {1.0, 2.0, 1.5, 1.5, 3.0, 0.1, 0.9, 1.0};
+
+struct driverState {
+    size_t flips = 0;
+    bool direction = true;
+};
+std::ostream& operator<<(std::ostream& out, const driverState& s) {
+    out << "{flips:" << s.flips << ", direction:" << s.direction << "}";
+    return out;
+}
+
+class driver: public Atomic<driverState> {
+    public:
+    Port<bool> out;
+
+    driver(const std::string id): Atomic<driverState>(id, driverState()) {
+        out = addOutPort<bool>("out");
+    }
+
+    void internalTransition(driverState& state) const override {
+        state.flips++;
+        state.direction = !state.direction;
+    }
+
+    void externalTransition(driverState&, double) const override {}
+
+    void output(const driverState& state) const override {
+        out->addMessage(!state.direction);
+    }
+
+    [[nodiscard]] double timeAdvance(const driverState& state) const override {
+        return driver_sigmas[state.flips % std::size(driver_sigmas)];
+    }
+};
+
+struct sinkState {
+    int received = 0;
+    std::vector<int> last;
+};
+std::ostream& operator<<(std::ostream& out, const sinkState& s) {
+    out << "{received:" << s.received << ", last:[";
+    for(size_t i = 0; i < s.last.size(); i++) {
+        out << (i ? ", " : "") << s.last[i];
+    }
+    out << "]}";
+    return out;
+}
+
+class sink: public Atomic<sinkState> {
+    public:
+    Port<int> in;
+
+    sink(const std::string id): Atomic<sinkState>(id, sinkState()) {
+        in = addInPort<int>("in");
+    }
+
+    void internalTransition(sinkState&) const override {}
+
+    void externalTransition(sinkState& state, double) const override {
+        state.last = in->getBag();
+        state.received += static_cast<int>(state.last.size());
+    }
+
+    void output(const sinkState&) const override {}
+
+    [[nodiscard]] double timeAdvance(const sinkState&) const override {
+        return std::numeric_limits<double>::infinity();
+    }
+};
+
+template<typename Model>
+struct bench: public Coupled {
+    bench(const std::string& id): Coupled(id) {
+        auto d = addComponent<driver>("driver");
+        auto m = addComponent<Model>("model");
+        auto s = addComponent<sink>("sink");
+        addCoupling(d->out, m->direction);
+        addCoupling(m->count, s->in);
+    }
+};
+
+struct event_t {
+    double time;
+    std::string model;
+    std::string state;
+};
+
+//! Collects every logged state in the order of the simulation
+class trace_t: public Logger {
+    std::vector<event_t>& events;
+
+    public:
+    trace_t(std::vector<event_t>& _events): events(_events) {}
+
+    void start() override {}
+    void stop() override {}
+    void logOutput(double, long, const std::string&, const std::string&, const std::string&) override {}
+
+    void logState(double time, long, const std::string& model, const std::string& state) override {
+        events.push_back({time, model, state});
+    }
+};
+
+template<typename Model>
+std::vector<event_t> simulate() {
+    std::vector<event_t> events;
+    auto root = RootCoordinator(std::make_shared<bench<Model>>("bench"));
+    root.template setLogger<trace_t>(events);
+    root.start();
+    while(root.getTopCoordinator()->getTimeNext() < end_time) {
+        root.simulate(1L);
+    }
+    root.stop();
+    return events;
+}
+
+std::string line(double time, const std::string& model, const std::string& state) {
+    char stamp[32];
+    std::snprintf(stamp, sizeof(stamp), "%.9f ", time);
+    return stamp + model + " " + state;
+}
+
+/**
+ * Lines of the plain run, the member states at each time either member
+ * logs at joined as counter_tester_fused0State prints them
+ */
+std::vector<std::string> plain_lines(const std::vector<event_t>& events) {
+    std::vector<std::string> lines;
+    std::map<std::string, std::string> members{{"counter_model", "?"}, {"generator_model", "?"}};
+    for(size_t i = 0; i < events.size();) {
+        bool touched = false;
+        size_t j = i;
+        for(; j < events.size() && events[j].time == events[i].time; j++) {
+            if(members.count(events[j].model)) {
+                members[events[j].model] = events[j].state;
+                touched = true;
+            } else {
+                lines.push_back(line(events[j].time, events[j].model, events[j].state));
+            }
+        }
+        if(touched) {
+            lines.push_back(line(events[i].time, "model", "{counter_model:" + members["counter_model"] + ", generator_model:" + members["generator_model"] + "}"));
+        }
+        i = j;
+    }
+    return lines;
+}
+
+std::vector<std::string> fused_lines(const std::vector<event_t>& events) {
+    std::vector<std::string> lines;
+    for(auto& event : events) {
+        lines.push_back(line(event.time, event.model == "fused0" ? "model" : event.model, event.state));
+    }
+    return lines;
+}
+
+int main() {
+    auto plain = plain_lines(simulate<counter_tester>());
+    auto fused = fused_lines(simulate<counter_tester_fused>());
+
+    // the order of models logging at one time is the simulator's business
+    std::sort(plain.begin(), plain.end());
+    std::sort(fused.begin(), fused.end());
+    size_t failures = 0;
+    for(size_t i = 0; i < std::max(plain.size(), fused.size()); i++) {
+        const char* expected = i < plain.size() ? plain[i].c_str() : "(none)";
+        const char* got = i < fused.size() ? fused[i].c_str() : "(none)";
+        if(std::string(expected) != got) {
+            std::fprintf(stderr, "line %zu: fused %s, plain %s\n", i, got, expected);
+            failures++;
+        }
+    }
+
+    std::printf("%zu states logged, %zu failures\n", plain.size(), failures);
+    return failures == 0 && !plain.empty() ? 0 : 1;
+}
+
+#else
+
+#include <cstdio>
+
+int main() {
+    std::printf("Cadmium not found, skipped\n");
+    return 77;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * Replay of delta-encoded state logs under sampling
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Drives devsmap::log_point_t the way a generated atomic logging state
+ * variables a and b with "every": 3 and "keyframe": 4 does, for a model
+ * whose transitions alternate between assigning a and assigning b, so
+ * sampled out transitions assign what logged ones do not. Replaying the
+ * keyframe and state lines must give, at every logged event, the state
+ * full-state logging with the same sampling writes.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "devsmap/log.hpp"
+
+struct component_t {
+    std::string getId() const {
+        return "t";
+    }
+
+    const component_t* getParent() const {
+        return nullptr;
+    }
+};
+
+int main() {
+    constexpr uint32_t a_bit = 1, b_bit = 2;
+    static constexpr devsmap::log_selection_t selection[] = {{nullptr, a_bit | b_bit}};
+    static constexpr devsmap::log_sampling_t sampling{3, 0.0};
+
+    component_t component;
+    devsmap::log_point_t full, delta;
+    int a = 0, b = 0;
+    int replayed_a = -1, replayed_b = -1;
+    size_t logged = 0, failures = 0;
+
+    for(int event = 0; event < 100; event++) {
+        double time = event + 1;
+        uint32_t written = 0;
+        if(event % 2 == 0) {
+            a++;
+            written |= a_bit;
+        } else {
+            b++;
+            written |= b_bit;
+        }
+
+        // full-state logging: the reference
+        bool reference = full.sample(component, selection, sampling, time) != 0;
+
+        delta.assign(written);
+        if(auto channels = delta.sample(component, selection, sampling, time)) {
+            bool keyframe = delta.keyframe(4);
+            channels = delta.delta(channels, keyframe);
+            if(channels & a_bit) {
+                replayed_a = a;
+            }
+            if(channels & b_bit) {
+                replayed_b = b;
+            }
+            if(!reference || replayed_a != a || replayed_b != b) {
+                std::fprintf(stderr, "event %d at %g: replayed {a:%d, b:%d}, logged state {a:%d, b:%d}\n", event, time, replayed_a, replayed_b, a, b);
+                failures++;
+            }
+            logged++;
+        } else if(reference) {
+            std::fprintf(stderr, "event %d at %g: logged by full-state logging only\n", event, time);
+            failures++;
+        }
+    }
+
+    std::printf("%zu logged events, %zu failures\n", logged, failures);
+    return failures == 0 && logged > 0 ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+/**
+ * Two partitions over UnixSocketTransport against the unpartitioned model
+ * Copyright (C) 2025  Sasisekhar Mangalam Govind
+ * ARSLab - Carleton University
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * ping sends a count every time unit and adds up what pong replies half a
+ * unit after each message. Cut between the two, as the partitioner does for
+ * a cycle, the partitions run in two threads with devsmap::simulate_partition
+ * and a lookahead of 0.5: every state of ping and pong they log must be the
+ * one the unpartitioned model logs at the same time. pong only ever acts on
+ * remote messages, so its partition advances by ProxyIn wake-ups alone.
+ *
+ * A datagram over UnixSocketTransport::max_frame, sent by hand, must be
+ * refused by the receiver rather than read truncated.
+ *
+ * Needs Cadmium (the CADMIUM environment variable at configure time);
+ * without it the test is skipped.
+ */
+
+#if __has_include("cadmium/simulation/root_coordinator.hpp")
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cadmium/modeling/devs/coupled.hpp"
+#include "cadmium/simulation/logger/logger.hpp"
+#include "cadmium/simulation/root_coordinator.hpp"
+#include "devsmap/proxy.hpp"
+
+using namespace cadmium;
+
+constexpr double end_time = 20.5;
+constexpr double reply_delay = 0.5;
+
+struct pingState {
+    int count = 0;
+    int received = 0;
+    double sigma = 1.0;
+};
+std::ostream& operator<<(std::ostream& out, const pingState& s) {
+    out << "{count:" << s.count << ", received:" << s.received << ", sigma:" << s.sigma << "}";
+    return out;
+}
+
+class ping: public Atomic<pingState> {
+    public:
+    Port<int> in;
+    Port<int> out;
+
+    ping(const std::string id): Atomic<pingState>(id, pingState()) {
+        in = addInPort<int>("in");
+        out = addOutPort<int>("out");
+    }
+
+    void internalTransition(pingState& state) const override {
+        state.count++;
+        state.sigma = 1.0;
+    }
+
+    void externalTransition(pingState& state, double e) const override {
+        for(auto& message : in->getBag()) {
+            state.received += message;
+        }
+        state.sigma -= e;
+    }
+
+    void output(const pingState& state) const override {
+        out->addMessage(state.count);
+    }
+
+    [[nodiscard]] double timeAdvance(const pingState& state) const override {
+        return state.sigma;
+    }
+};
+
+struct pongState {
+    int reply = 0;
+    double sigma = std::numeric_limits<double>::infinity();
+};
+std::ostream& operator<<(std::ostream& out, const pongState& s) {
+    out << "{reply:" << s.reply << ", sigma:" << s.sigma << "}";
+    return out;
+}
+
+class pong: public Atomic<pongState> {
+    public:
+    Port<int> in;
+    Port<int> out;
+
+    pong(const std::string id): Atomic<pongState>(id, pongState()) {
+        in = addInPort<int>("in");
+        out = addOutPort<int>("out");
+    }
+
+    void internalTransition(pongState& state) const override {
+        state.sigma = std::numeric_limits<double>::infinity();
+    }
+
+    void externalTransition(pongState& state, double e) const override {
+        for(auto& message : in->getBag()) {
+            state.reply = 2 * message + 1;
+        }
+        state.sigma = reply_delay;
+    }
+
+    void output(const pongState& state) const override {
+        out->addMessage(state.reply);
+    }
+
+    [[nodiscard]] double timeAdvance(const pongState& state) const override {
+        return state.sigma;
+    }
+};
+
+struct ping_pong: public Coupled {
+    ping_pong(const std::string& id): Coupled(id) {
+        auto a = addComponent<ping>("a");
+        auto b = addComponent<pong>("b");
+        addCoupling(a->out, b->in);
+        addCoupling(b->out, a->in);
+    }
+};
+
+//! What the partitioner emits for ping_pong cut in two: channel 0 carries a->out, channel 1 b->out
+struct ping_pong_part0: public Coupled {
+    ping_pong_part0(const std::string& id, std::shared_ptr<devsmap::ChannelHub> hub): Coupled(id) {
+        auto a = addComponent<ping>("a");
+        auto proxy_out_0 = addComponent<devsmap::ProxyOut<int>>("proxy_out_0", hub, 0, 1);
+        addCoupling(a->out, proxy_out_0->in);
+        auto proxy_in_1 = addComponent<devsmap::ProxyIn<int>>("proxy_in_1", hub, 1);
+        addCoupling(proxy_in_1->out, a->in);
+    }
+};
+
+struct ping_pong_part1: public Coupled {
+    ping_pong_part1(const std::string& id, std::shared_ptr<devsmap::ChannelHub> hub): Coupled(id) {
+        auto b = addComponent<pong>("b");
+        auto proxy_in_0 = addComponent<devsmap::ProxyIn<int>>("proxy_in_0", hub, 0);
+        addCoupling(proxy_in_0->out, b->in);
+        auto proxy_out_1 = addComponent<devsmap::ProxyOut<int>>("proxy_out_1", hub, 1, 0);
+        addCoupling(b->out, proxy_out_1->in);
+    }
+};
+
+//! Collects "time model state" lines of every model but the proxies
+class trace_t: public Logger {
+    std::mutex& mutex;
+    std::vector<std::string>& lines;
+
+    public:
+    trace_t(std::mutex& _mutex, std::vector<std::string>& _lines): mutex(_mutex), lines(_lines) {}
+
+    void start() override {}
+    void stop() override {}
+    void logOutput(double, long, const std::string&, const std::string&, const std::string&) override {}
+
+    void logState(double time, long, const std::string& model, const std::string& state) override {
+        if(model.rfind("proxy", 0) == 0) {
+            return;
+        }
+        char stamp[32];
+        std::snprintf(stamp, sizeof(stamp), "%.6f ", time);
+        std::lock_guard<std::mutex> lock(mutex);
+        lines.push_back(stamp + model + " " + state);
+    }
+};
+
+int main() {
+    std::mutex mutex;
+    std::vector<std::string> reference, partitioned;
+
+    {
+        auto model = std::make_shared<ping_pong>("ping_pong");
+        auto root = RootCoordinator(model);
+        root.setLogger<trace_t>(mutex, reference);
+        root.start();
+        while(root.getTopCoordinator()->getTimeNext() < end_time) {
+            root.simulate(1L);
+        }
+        root.stop();
+    }
+
+    char directory[] = "/tmp/devsmap_partition_XXXXXX";
+    if(!mkdtemp(directory)) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+
+    auto run = [&](size_t partition) {
+        auto hub = std::make_shared<devsmap::ChannelHub>(std::make_shared<devsmap::UnixSocketTransport>(directory, partition));
+        std::shared_ptr<Coupled> model;
+        if(partition == 0) {
+            model = std::make_shared<ping_pong_part0>("ping_pong_part0", hub);
+        } else {
+            model = std::make_shared<ping_pong_part1>("ping_pong_part1", hub);
+        }
+        auto root = RootCoordinator(model);
+        root.setLogger<trace_t>(mutex, partitioned);
+        root.start();
+        devsmap::simulate_partition(root, *hub, end_time, reply_delay, std::set<std::string>{partition == 0 ? "a" : "b"});
+        root.stop();
+    };
+    std::thread part1(run, 1);
+    run(0);
+    part1.join();
+
+    std::sort(reference.begin(), reference.end());
+    std::sort(partitioned.begin(), partitioned.end());
+    size_t failures = 0;
+    for(size_t i = 0; i < std::max(reference.size(), partitioned.size()); i++) {
+        const char* expected = i < reference.size() ? reference[i].c_str() : "(none)";
+        const char* got = i < partitioned.size() ? partitioned[i].c_str() : "(none)";
+        if(std::string(expected) != got) {
+            std::fprintf(stderr, "line %zu: partitioned %s, unpartitioned %s\n", i, got, expected);
+            failures++;
+        }
+    }
+
+    // an oversized datagram must be refused whole, not read truncated
+    bool refused = false;
+    {
+        devsmap::UnixSocketTransport receiver(directory, 2);
+        int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/part2.sock", directory);
+        std::string frame(devsmap::UnixSocketTransport::max_frame + 1, 'x');
+        if(sendto(fd, frame.data(), frame.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::perror("sendto");
+        } else {
+            try {
+                std::string received;
+                receiver.try_receive(received);
+            } catch(const std::runtime_error&) {
+                refused = true;
+            }
+        }
+        close(fd);
+    }
+    std::filesystem::remove_all(directory);
+    if(!refused) {
+        std::fprintf(stderr, "a frame of %zu bytes was not refused\n", devsmap::UnixSocketTransport::max_frame + 1);
+        failures++;
+    }
+
+    std::printf("%zu states logged, %zu failures\n", reference.size(), failures);
+    return failures == 0 && !reference.empty() ? 0 : 1;
+}
+
+#else
+
+#include <cstdio>
+
+int main() {
+    std::printf("Cadmium not found, skipped\n");
+    return 77;
+}
+
+#endif